@@ -0,0 +1,307 @@
+// Drives the exported API of main.wasm in loops, without a browser.
+//
+//   node bench/bench.mjs [--time 1000] [--filter solve] [--wasm web/main.wasm]
+//   bun bench/bench.mjs
+//
+// Build main.wasm first, ideally as Release since that is what ships. Each
+// case runs for --time milliseconds after a short warm-up and reports ops/sec
+// over the whole run and per-operation latency percentiles. Per-operation
+// times include one clock read, roughly what the "boundary" case reports.
+import { readFile } from "node:fs/promises";
+import { fileURLToPath } from "node:url";
+
+const BOARD_SIZE = 81;
+const SIDE_LENGTH = 9;
+const WARMUP_MS = 100;
+// Search nodes per check_solvable() slice, as the page uses for generation
+const SEARCH_SLICE_NODES = 2000;
+
+function parseArgs(argv) {
+  const options = {
+    time: 1000,
+    filter: "",
+    wasm: fileURLToPath(new URL("../web/main.wasm", import.meta.url)),
+  };
+  for (let i = 0; i < argv.length; i += 2) {
+    const value = argv[i + 1];
+    if (argv[i] === "--time") options.time = Number(value);
+    else if (argv[i] === "--filter") options.filter = value;
+    else if (argv[i] === "--wasm") options.wasm = value;
+    else throw new Error(`Unknown option ${argv[i]}`);
+  }
+  return options;
+}
+
+async function instantiate(path) {
+  const noop = () => {};
+  const { instance } = await WebAssembly.instantiate(await readFile(path), {
+    env: {
+      console_log: noop,
+      console_info: noop,
+      console_error: noop,
+      console_warn: noop,
+    },
+  });
+  return instance.exports;
+}
+
+const now = () => Number(process.hrtime.bigint());
+
+/**
+ * Calls `run` until `time` ms have passed. `setup` runs before every call and
+ * is not timed. `run` returns how many operations it did, 1 by default.
+ */
+function measure(time, { setup, run }) {
+  const latencies = [];
+  let ops = 0;
+  let busy = 0;
+
+  for (const duration of [WARMUP_MS, time]) {
+    latencies.length = 0;
+    ops = 0;
+    busy = 0;
+
+    const end = now() + duration * 1e6;
+    while (now() < end) {
+      setup?.();
+      const start = now();
+      const done = run() ?? 1;
+      const elapsed = now() - start;
+
+      busy += elapsed;
+      ops += done;
+      latencies.push(elapsed / done);
+    }
+  }
+
+  latencies.sort((a, b) => a - b);
+  const percentile = (p) =>
+    latencies[Math.min(latencies.length - 1, Math.floor(latencies.length * p))];
+
+  return {
+    opsPerSec: ops / (busy / 1e9),
+    p50: percentile(0.5),
+    p90: percentile(0.9),
+    p99: percentile(0.99),
+    max: latencies[latencies.length - 1],
+  };
+}
+
+function defineCases(wasm) {
+  const puzzles = wasm.get_embedded_puzzle_count();
+  let puzzle = 0;
+  const loadPuzzle = (backend = 0) => {
+    wasm.set_solver_backend(backend);
+    wasm.load_embedded_puzzle(puzzle++ % puzzles);
+    wasm.take_dirty_cells();
+  };
+  const CDCL = 1; // SolverBackend from sudoku.h
+  const SYMMETRY_ROTATE_180 = 1; // Symmetry from generator.h
+
+  // Resizing clears the transposition table, so only do it when switching.
+  // The table is off by default.
+  const CACHE_BITS = 15;
+  const useCache = (bits) => {
+    if (wasm.get_transposition_table_bits() !== bits)
+      wasm.set_transposition_table_bits(bits);
+  };
+
+  let index = 0;
+  const gridCount = 16;
+  const grids = wasm.malloc(gridCount * BOARD_SIZE);
+
+  // Same decoding as WasmInterface.getBoardData()
+  const readBoard = (pointer) => {
+    const cells = new BigUint64Array(wasm.memory.buffer, pointer, BOARD_SIZE);
+    let sum = 0;
+    for (const cell of cells) sum += Number((cell >> 16n) & 0xffn);
+    return sum;
+  };
+
+  // As many 81-character lines as fit the import buffer (IMPORT_BUFFER_SIZE)
+  const line =
+    "......1.36....8..7..7.96..8.4.7.5...7.2....81..1....5.5.8..2.....4.7..2........1.\n";
+  const lines = Math.floor(65536 / line.length);
+  const importText = new TextEncoder().encode(line.repeat(lines));
+  const importBuffer = wasm.get_import_buffer();
+
+  return [
+    {
+      name: "boundary: get_board_size",
+      run: () => void wasm.get_board_size(),
+    },
+    {
+      name: "generate: fill_random_board",
+      setup: () => {
+        useCache(0);
+        wasm.seed_puzzle(1n, index++);
+      },
+      run: () => void wasm.fill_random_board(),
+    },
+    {
+      name: "generate: fill_random_board (2^15 cache)",
+      setup: () => {
+        useCache(CACHE_BITS);
+        wasm.seed_puzzle(1n, index++);
+      },
+      run: () => void wasm.fill_random_board(),
+    },
+    {
+      name: "generate: minimal, 24 clues",
+      setup: () => {
+        useCache(0);
+        wasm.set_generator_options(0, 24);
+        wasm.seed_puzzle(1n, index++);
+      },
+      run: () => {
+        wasm.fill_random_board();
+        wasm.set_generator_options(0, 0);
+      },
+    },
+    {
+      name: "generate: 180° symmetric",
+      setup: () => {
+        useCache(0);
+        wasm.set_generator_options(SYMMETRY_ROTATE_180, 0);
+        wasm.seed_puzzle(1n, index++);
+      },
+      run: () => {
+        wasm.fill_random_board();
+        wasm.set_generator_options(0, 0);
+      },
+    },
+    {
+      name: "generate: generate_grids x16",
+      run: () => wasm.generate_grids(grids, gridCount),
+    },
+    {
+      name: "solve: solve_sudoku",
+      setup: loadPuzzle,
+      run: () => void wasm.solve_sudoku(),
+    },
+    {
+      name: "solve: count_all_solutions(2)",
+      setup: loadPuzzle,
+      run: () => void wasm.count_all_solutions(2n),
+    },
+    {
+      name: "solve: solve_sudoku (cdcl)",
+      setup: () => loadPuzzle(CDCL),
+      run: () => void wasm.solve_sudoku(),
+    },
+    {
+      name: "solve: count_all_solutions(2) (cdcl)",
+      setup: () => loadPuzzle(CDCL),
+      run: () => void wasm.count_all_solutions(2n),
+    },
+    {
+      name: "hint: find_next_step",
+      setup: loadPuzzle,
+      run: () => void wasm.find_next_step(),
+    },
+    {
+      name: "import: 81-char lines",
+      setup: () => {
+        wasm.clear_corpus();
+        new Uint8Array(wasm.memory.buffer, importBuffer).set(importText);
+      },
+      run: () => {
+        wasm.import_chunk(importBuffer, importText.length);
+        return lines;
+      },
+    },
+    {
+      name: "read: get_board",
+      run: () => void readBoard(wasm.get_board()),
+    },
+    {
+      name: "read: get_candidates",
+      run: () =>
+        void new Uint16Array(
+          wasm.memory.buffer,
+          wasm.get_candidates(),
+          BOARD_SIZE,
+        ).reduce((a, b) => a | b, 0),
+    },
+    {
+      // Plays the solution into every empty cell the way the page does
+      name: "moves: set_board_value + sync",
+      setup: loadPuzzle,
+      run: () => {
+        const solution = new BigUint64Array(
+          wasm.memory.buffer,
+          wasm.get_solved_board(),
+          BOARD_SIZE,
+        ).map((cell) => (cell >> 16n) & 0xffn);
+        let moves = 0;
+
+        for (let i = 0; i < BOARD_SIZE; ++i) {
+          const x = i % SIDE_LENGTH;
+          const y = Math.floor(i / SIDE_LENGTH);
+          if (wasm.get_board_value(x, y) !== 0) continue;
+
+          wasm.set_board_value(Number(solution[i]), x, y, false);
+          wasm.take_dirty_cells();
+          wasm.get_conflict_count();
+          moves++;
+        }
+
+        if (!wasm.is_board_solved()) throw new Error("Move sequence failed");
+        return moves;
+      },
+    },
+    {
+      // A wrong digit in the first empty cell, found and blamed from scratch
+      name: "moves: wrong entry + check_solvable",
+      setup: () => {
+        loadPuzzle();
+        while (wasm.check_solvable(SEARCH_SLICE_NODES) === 0);
+      },
+      run: () => {
+        const solution = new BigUint64Array(
+          wasm.memory.buffer,
+          wasm.get_solved_board(),
+          BOARD_SIZE,
+        ).map((cell) => (cell >> 16n) & 0xffn);
+        const i = new BigUint64Array(
+          wasm.memory.buffer,
+          wasm.get_board(),
+          BOARD_SIZE,
+        ).findIndex((cell) => ((cell >> 16n) & 0xffn) === 0n);
+
+        const x = i % SIDE_LENGTH;
+        const y = Math.floor(i / SIDE_LENGTH);
+        wasm.set_board_value((Number(solution[i]) % 9) + 1, x, y, false);
+
+        // Solvability from oracle.h: UNKNOWN, SOLVABLE, UNSOLVABLE
+        let verdict;
+        while ((verdict = wasm.check_solvable(SEARCH_SLICE_NODES)) === 0);
+        if (verdict !== 2) throw new Error("Wrong entry not detected");
+      },
+    },
+  ];
+}
+
+const formatTime = (ns) =>
+  ns >= 1e6 ? `${(ns / 1e6).toFixed(2)} ms` : `${(ns / 1e3).toFixed(2)} µs`;
+
+const options = parseArgs(process.argv.slice(2));
+const wasm = await instantiate(options.wasm);
+wasm.setup(1);
+
+console.log(
+  `${"case".padEnd(40)}${"ops/s".padStart(12)}` +
+    ["p50", "p90", "p99", "max"].map((h) => h.padStart(11)).join(""),
+);
+for (const bench of defineCases(wasm)) {
+  if (!bench.name.includes(options.filter)) continue;
+
+  const result = measure(options.time, bench);
+  console.log(
+    `${bench.name.padEnd(40)}` +
+      `${Math.round(result.opsPerSec).toLocaleString("en-US").padStart(12)}` +
+      [result.p50, result.p90, result.p99, result.max]
+        .map((ns) => formatTime(ns).padStart(11))
+        .join(""),
+  );
+}
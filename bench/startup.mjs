@@ -0,0 +1,252 @@
+// Measures fetch-to-first-board time of the page in headless Chrome.
+//
+//   node bench/startup.mjs [--runs 10] [--network slow3g|fast3g|none]
+//                          [--chrome google-chrome]
+//
+// Build main.wasm and the page first. Uses an installed Chrome or Chromium,
+// --chrome or the CHROME environment variable, driven through the DevTools
+// protocol over a pipe. Every run uses a fresh browser context with the cache
+// disabled, so it is a cold start.
+import { spawn } from "node:child_process";
+import { createServer } from "node:http";
+import { mkdtemp, readFile, rm } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { extname, join, normalize } from "node:path";
+import { fileURLToPath } from "node:url";
+
+const root = fileURLToPath(new URL("../web/", import.meta.url));
+
+const mimeTypes = {
+  ".html": "text/html",
+  ".css": "text/css",
+  ".mjs": "text/javascript",
+  ".js": "text/javascript",
+  ".wasm": "application/wasm",
+};
+
+// Chrome DevTools presets
+const networks = {
+  slow3g: {
+    latency: 400,
+    download: (500 * 1024) / 8,
+    upload: (500 * 1024) / 8,
+  },
+  fast3g: {
+    latency: 150,
+    download: (1.6 * 1024 * 1024) / 8,
+    upload: (750 * 1024) / 8,
+  },
+  none: null,
+};
+
+function parseArgs(argv) {
+  const options = {
+    runs: 10,
+    network: "none",
+    chrome: process.env.CHROME ?? "google-chrome",
+  };
+  for (let i = 0; i < argv.length; i += 2) {
+    const value = argv[i + 1];
+    if (argv[i] === "--runs") options.runs = Number(value);
+    else if (argv[i] === "--network") options.network = value;
+    else if (argv[i] === "--chrome") options.chrome = value;
+    else throw new Error(`Unknown option ${argv[i]}`);
+  }
+  if (!(options.network in networks)) {
+    throw new Error(`Unknown network profile ${options.network}`);
+  }
+  return options;
+}
+
+function serve() {
+  const server = createServer(async (request, response) => {
+    const path = normalize(new URL(request.url, "http://localhost").pathname);
+    const file = join(root, path.endsWith("/") ? `${path}index.html` : path);
+    try {
+      const body = await readFile(file);
+      response.writeHead(200, {
+        "Content-Type": mimeTypes[extname(file)] ?? "application/octet-stream",
+      });
+      response.end(body);
+    } catch {
+      response.writeHead(404).end();
+    }
+  });
+
+  return new Promise((resolve) =>
+    server.listen(0, "127.0.0.1", () => resolve(server)),
+  );
+}
+
+function median(values) {
+  const sorted = [...values].sort((a, b) => a - b);
+  const middle = sorted.length >> 1;
+  return sorted.length % 2
+    ? sorted[middle]
+    : (sorted[middle - 1] + sorted[middle]) / 2;
+}
+
+/**
+ * Starts headless Chrome with --remote-debugging-pipe. DevTools messages are
+ * JSON separated by NUL bytes, written to fd 3 and read from fd 4.
+ */
+async function launch(chrome) {
+  const profile = await mkdtemp(join(tmpdir(), "sudoku-startup-"));
+  const child = spawn(
+    chrome,
+    [
+      "--headless=new",
+      "--remote-debugging-pipe",
+      "--no-first-run",
+      "--no-default-browser-check",
+      `--user-data-dir=${profile}`,
+      "about:blank",
+    ],
+    { stdio: ["ignore", "ignore", "inherit", "pipe", "pipe"] },
+  );
+  const [, , , input, output] = child.stdio;
+
+  let nextId = 0;
+  const pending = new Map();
+  const listeners = new Map();
+  let buffered = "";
+
+  output.setEncoding("utf8");
+  output.on("data", (data) => {
+    const messages = (buffered + data).split("\0");
+    buffered = messages.pop();
+
+    for (const text of messages) {
+      const message = JSON.parse(text);
+      if (message.id !== undefined) {
+        const { resolve, reject } = pending.get(message.id);
+        pending.delete(message.id);
+        if (message.error) reject(new Error(message.error.message));
+        else resolve(message.result);
+      } else {
+        const key = `${message.sessionId}:${message.method}`;
+        listeners.get(key)?.(message.params);
+        listeners.delete(key);
+      }
+    }
+  });
+
+  const failed = new Promise((_, reject) => {
+    child.on("error", reject);
+    child.on("exit", (code) =>
+      reject(new Error(`${chrome} exited with code ${code}`)),
+    );
+  });
+  failed.catch(() => {});
+  // Writes fail once Chrome is gone, failed reports why
+  input.on("error", () => {});
+
+  return {
+    send(method, params = {}, sessionId) {
+      const id = ++nextId;
+      input.write(`${JSON.stringify({ id, method, params, sessionId })}\0`);
+      return Promise.race([
+        new Promise((resolve, reject) =>
+          pending.set(id, { resolve, reject }),
+        ),
+        failed,
+      ]);
+    },
+    // Resolves on the next event of that name, register before triggering it
+    once(method, sessionId) {
+      return new Promise((resolve) =>
+        listeners.set(`${sessionId}:${method}`, resolve),
+      );
+    },
+    async close() {
+      await this.send("Browser.close").catch(() => {});
+      child.kill();
+      await rm(profile, { recursive: true, force: true });
+    },
+  };
+}
+
+async function measure(browser, url, network) {
+  const { browserContextId } = await browser.send(
+    "Target.createBrowserContext",
+  );
+  const { targetId } = await browser.send("Target.createTarget", {
+    url: "about:blank",
+    browserContextId,
+  });
+  const { sessionId } = await browser.send("Target.attachToTarget", {
+    targetId,
+    flatten: true,
+  });
+  const send = (method, params) => browser.send(method, params, sessionId);
+
+  await send("Page.enable");
+  await send("Network.enable");
+  await send("Network.setCacheDisabled", { cacheDisabled: true });
+  if (network) {
+    await send("Network.emulateNetworkConditions", {
+      offline: false,
+      latency: network.latency,
+      downloadThroughput: network.download,
+      uploadThroughput: network.upload,
+    });
+  }
+
+  const loaded = browser.once("Page.loadEventFired", sessionId);
+  await send("Page.navigate", { url });
+  await loaded;
+
+  // Waits in the page for the first-board mark, then reads all the marks
+  const { result, exceptionDetails } = await send("Runtime.evaluate", {
+    expression: `new Promise((resolve, reject) => {
+      const entry = (name) => performance.getEntriesByName(name)[0];
+      const timeout = setTimeout(
+        () => reject(new Error("No first-board mark")),
+        120_000,
+      );
+      const poll = () => {
+        if (!entry("first-board")) return setTimeout(poll, 10);
+        clearTimeout(timeout);
+        resolve({
+          firstBoard: entry("first-board").startTime,
+          wasmLoad: entry("wasm-load").duration,
+          wasmToFirstBoard: entry("wasm-to-first-board").duration,
+        });
+      };
+      poll();
+    })`,
+    awaitPromise: true,
+    returnByValue: true,
+  });
+  if (exceptionDetails) throw new Error(exceptionDetails.text);
+
+  await browser.send("Target.disposeBrowserContext", { browserContextId });
+  return result.value;
+}
+
+const options = parseArgs(process.argv.slice(2));
+const server = await serve();
+const url = `http://127.0.0.1:${server.address().port}/`;
+const browser = await launch(options.chrome);
+
+const runs = [];
+try {
+  for (let i = 0; i < options.runs; ++i) {
+    runs.push(await measure(browser, url, networks[options.network]));
+  }
+} finally {
+  await browser.close();
+  server.close();
+}
+
+const wasm = await readFile(join(root, "main.wasm"));
+console.log(`main.wasm: ${wasm.byteLength} bytes`);
+console.log(`network: ${options.network}, runs: ${options.runs}`);
+for (const key of ["firstBoard", "wasmLoad", "wasmToFirstBoard"]) {
+  const values = runs.map((run) => run[key]);
+  console.log(
+    `${key.padEnd(18)} median ${median(values).toFixed(1)} ms, ` +
+      `min ${Math.min(...values).toFixed(1)} ms, ` +
+      `max ${Math.max(...values).toFixed(1)} ms`,
+  );
+}
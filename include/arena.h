@@ -0,0 +1,39 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ARENA_ALIGNMENT 8
+
+/**
+ * Bump allocator over a single block obtained from malloc. Objects are never
+ * freed one by one, the whole arena is reset (or rewound to a mark) at the end
+ * of an operation in O(1).
+ */
+typedef struct {
+  uint8_t *base;
+  size_t capacity;
+  size_t offset;
+  size_t high_water; // largest offset ever reached
+} Arena;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool arena_init(Arena *arena, const size_t capacity);
+void arena_release(Arena *arena);
+
+/** Returns ARENA_ALIGNMENT aligned memory, or NULL if the arena is full. */
+void *arena_alloc(Arena *arena, const size_t size);
+
+size_t arena_mark(const Arena *arena);
+void arena_rewind(Arena *arena, const size_t mark);
+void arena_reset(Arena *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ARENA_H_
@@ -0,0 +1,118 @@
+#ifndef CDCL_H_
+#define CDCL_H_
+
+#include "sudoku.h"
+#include <stdint.h>
+
+// One variable per cell and digit, variable cell * CELL_VALUE_MAX + digit - 1.
+// Literal 2 * variable is the variable, 2 * variable + 1 its negation.
+#define CDCL_VARIABLES (BOARD_SIZE * CELL_VALUE_MAX)
+#define CDCL_LITERALS (CDCL_VARIABLES * 2)
+
+// Clause storage. The original clauses take 324 slots and 2916 literals, the
+// rest is learned and blocking clauses.
+#define CDCL_MAX_CLAUSES 2048
+#define CDCL_POOL_SIZE 16384
+
+// Variable values
+#define CDCL_FALSE 0
+#define CDCL_TRUE 1
+#define CDCL_UNASSIGNED 2
+
+// Conflicts before the first restart, scaled by the Luby sequence
+#define CDCL_RESTART_BASE 64
+
+typedef enum {
+  CDCL_SAT,   // values holds a solution
+  CDCL_UNSAT, // no solution left
+  CDCL_FULL,  // the clause storage is full of clauses that cannot be dropped
+} CdclResult;
+
+/**
+ * Conflict-driven clause learning over the cell/digit encoding. "At least one"
+ * constraints (every cell has a digit, every unit has every digit) are
+ * clauses with two watched literals. The matching "at most one" constraints
+ * are propagated directly from the unit tables instead of being stored as
+ * 11664 binary clauses.
+ *
+ * Everything lives in the struct, about 70 KiB, so the solver never
+ * allocates. Learned clauses are dropped by LBD when the storage fills up.
+ */
+typedef struct {
+  uint16_t pool[CDCL_POOL_SIZE]; // clause literals
+  uint16_t pool_size;
+
+  uint16_t clause_start[CDCL_MAX_CLAUSES];
+  uint16_t clause_size[CDCL_MAX_CLAUSES];
+  uint8_t clause_lbd[CDCL_MAX_CLAUSES]; // 0 for clauses that are never dropped
+  uint16_t clause_count;
+
+  // Watch lists are linked through the clauses. Watch 2 * clause + k watches
+  // literal k of the clause.
+  uint16_t watch_head[CDCL_LITERALS];
+  uint16_t watch_next[CDCL_MAX_CLAUSES * 2];
+
+  uint8_t assignment[CDCL_VARIABLES]; // CDCL_FALSE, CDCL_TRUE or unassigned
+  uint8_t phase[CDCL_VARIABLES];      // last value, tried first on decisions
+  uint8_t seen[CDCL_VARIABLES];
+  uint16_t level[CDCL_VARIABLES];
+  uint32_t reason[CDCL_VARIABLES];
+  float activity[CDCL_VARIABLES];
+  float activity_increment;
+
+  uint16_t trail[CDCL_VARIABLES];
+  uint16_t trail_size;
+  uint16_t propagated; // trail entries whose consequences are propagated
+  uint16_t level_start[CDCL_VARIABLES + 1];
+  uint16_t decision_level;
+
+  uint16_t learned[CDCL_VARIABLES];
+  uint32_t level_stamp[CDCL_VARIABLES + 1];
+  uint32_t stamp;
+
+  uint32_t conflicts;
+  uint32_t restart_limit;
+  uint32_t restarts;
+  bool unsat;
+
+  uint8_t values[BOARD_SIZE];
+} Cdcl;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Prepares a solver for BOARD_SIZE values (CELL_VALUE_EMPTY for blanks). */
+void cdcl_init(Cdcl *cdcl, const uint8_t *values);
+
+/**
+ * Looks for a solution. After CDCL_SAT, cdcl_block() excludes it so the next
+ * call finds another one.
+ */
+CdclResult cdcl_solve(Cdcl *cdcl);
+
+/**
+ * Adds a clause ruling out the solution in values. Returns false once these
+ * clauses would take more than half of the clause storage.
+ */
+bool cdcl_block(Cdcl *cdcl);
+
+/**
+ * Solves values into solution with a solver taken from the scratch arena.
+ * CDCL_FULL, also returned when the solver does not fit in the arena, means
+ * the board was not decided.
+ */
+CdclResult cdcl_solve_values(const uint8_t *values, uint8_t *solution);
+
+/**
+ * Counts the solutions of values into count, stopping at limit (0 = none).
+ * Every solution found takes a blocking clause, so returns false when they no
+ * longer fit; count then holds the solutions found so far.
+ */
+bool cdcl_count(const uint8_t *values, const uint64_t limit, uint64_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CDCL_H_
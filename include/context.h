@@ -0,0 +1,62 @@
+#ifndef CONTEXT_H_
+#define CONTEXT_H_
+
+#include "enumerate.h"
+#include "generator.h"
+#include "hints.h"
+#include "journal.h"
+#include "oracle.h"
+#include "rand.h"
+#include "sudoku.h"
+#include "units.h"
+#include <stdint.h>
+
+/**
+ * Everything one game needs: the board, its solution, the incremental
+ * candidate and conflict tracking, the generator and the state of the
+ * resumable operations. Only what is in this struct belongs to one game.
+ * Module-level state is shared by every context: the scratch arena (rewound
+ * by every operation before it returns), the transposition table, the trace
+ * ring and the imported corpus.
+ */
+struct SudokuContext {
+  SudokuCell board[BOARD_SIZE];
+  SudokuCell solved_board[BOARD_SIZE];
+
+  DirtyCells dirty_cells;
+  DirtyCells taken_dirty_cells;
+
+  // Board tracking, see sudoku.c
+  uint8_t unit_digit_counts[UNIT_COUNT][CELL_VALUE_MAX];
+  uint16_t candidates[BOARD_SIZE];
+  uint32_t conflicts[CELL_BITSET_WORDS];
+  uint8_t conflict_count;
+  uint8_t correct_cells; // cells equal to solved_board
+  uint8_t filled_cells;
+  bool tracking_ready;
+  uint32_t candidate_epoch;
+
+  Journal journal;
+
+  Rng rng;
+
+  GeneratorOptions generator_options;
+
+  // Puzzle generated ahead of time by sudoku_prepare_random_board() or
+  // sudoku_generate_step()
+  uint8_t prepared_givens[BOARD_SIZE];
+  uint8_t prepared_solution[BOARD_SIZE];
+  bool has_prepared_board;
+
+  // Resumable operations, see sudoku_solve_step() and sudoku_generate_step()
+  SolverBackend solver_backend;
+  Search solve;
+  TaskStatus solve_status;
+  Generation generation;
+
+  Oracle oracle;
+  Enumeration enumeration;
+  HintState hints;
+};
+
+#endif // CONTEXT_H_
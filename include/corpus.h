@@ -0,0 +1,95 @@
+#ifndef CORPUS_H_
+#define CORPUS_H_
+
+#include "sudoku.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Givens packed two per byte, low nibble first
+#define CORPUS_PUZZLE_SIZE ((BOARD_SIZE + 1) / 2)
+
+// Puzzles the corpus makes room for when it first grows
+#define CORPUS_INITIAL_CAPACITY 1024
+
+// Size of the buffer returned by get_import_buffer()
+#define IMPORT_BUFFER_SIZE 65536
+
+/**
+ * Imported puzzles, givens only. Solutions are found when a puzzle is loaded,
+ * so importing never searches.
+ */
+typedef struct {
+  uint8_t *puzzles; // count * CORPUS_PUZZLE_SIZE bytes
+  uint32_t count;
+  uint32_t capacity;
+} Corpus;
+
+typedef enum {
+  IMPORT_LINE_CELLS,   // reading digits, '.' or '0'
+  IMPORT_LINE_TRAILER, // whitespace after the cells, the rest is ignored
+  IMPORT_LINE_COMMENT, // '#' comment or '[Puzzle]' style header
+  IMPORT_LINE_BAD,     // unexpected character or too many cells
+} ImportLineState;
+
+/**
+ * Parser state between chunks. A puzzle is either one line of BOARD_SIZE cells
+ * or BOARD_SIDE_LENGTH consecutive lines of BOARD_SIDE_LENGTH cells (.sdk).
+ * Cells are written straight into cells, so nothing is buffered when a line
+ * or grid is split across chunks.
+ */
+typedef struct {
+  uint8_t cells[BOARD_SIZE];
+  uint8_t filled;     // cells of the finished rows of an .sdk grid
+  uint8_t line_cells; // cells read on the current line
+  uint8_t line_state; // ImportLineState
+  uint32_t malformed;
+} Importer;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Scratch buffer of IMPORT_BUFFER_SIZE bytes the host can copy chunks to. */
+uint8_t *get_import_buffer(void);
+
+/**
+ * Parses the next length bytes of a puzzle file into the corpus. Chunks may
+ * split lines and grids anywhere. Lines with other characters, rows of the
+ * wrong length, incomplete grids and puzzles repeating a digit in a unit are
+ * counted as malformed and skipped. Returns false if the corpus could not
+ * grow; the rest of the chunk is then dropped.
+ */
+bool import_chunk(const uint8_t *data, const size_t length);
+
+/**
+ * Ends the file: parses a last line with no line break and counts a trailing
+ * incomplete grid as malformed. The next chunk starts a new file.
+ */
+bool import_finish(void);
+
+/** Lines and grids skipped since the corpus was last cleared. */
+uint32_t get_import_malformed(void);
+
+uint32_t get_corpus_size(void);
+
+/**
+ * Unpacks the givens of a corpus puzzle into BOARD_SIZE values. Returns false
+ * for a bad index.
+ */
+bool get_corpus_puzzle(const uint32_t index, uint8_t *out);
+
+/** Frees the corpus and resets the parser and the malformed count. */
+void clear_corpus(void);
+
+/**
+ * Loads a corpus puzzle with its first solution. Returns false for a bad
+ * index or a puzzle with no solution.
+ */
+bool sudoku_load_corpus_puzzle(SudokuContext *ctx, const uint32_t index);
+bool load_corpus_puzzle(const uint32_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CORPUS_H_
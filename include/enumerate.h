@@ -0,0 +1,57 @@
+#ifndef ENUMERATE_H_
+#define ENUMERATE_H_
+
+#include "search.h"
+#include "sudoku.h"
+#include <stdint.h>
+
+// Per-context enumeration state
+typedef struct {
+  Search search;
+  uint64_t limit;
+  uint64_t count; // solutions produced so far
+} Enumeration;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Starts enumerating the solutions of the board of ctx. A limit of 0 means
+ * every solution. Returns false if the board already breaks a unit.
+ */
+bool sudoku_enumerate_begin(SudokuContext *ctx, const uint64_t limit);
+
+/**
+ * Writes up to capacity solutions to out, BOARD_SIZE digits each, and returns
+ * how many were written. The enumeration pauses when the buffer is full and
+ * the next call resumes where it stopped. With out set to NULL, solutions are
+ * only counted.
+ */
+uint32_t sudoku_enumerate_next(SudokuContext *ctx, uint8_t *out,
+                               const uint32_t capacity);
+
+/** Number of solutions produced since sudoku_enumerate_begin(). */
+uint64_t sudoku_get_enumerated_count(const SudokuContext *ctx);
+
+bool sudoku_is_enumeration_done(const SudokuContext *ctx);
+
+/**
+ * Counts the solutions of the board, stopping at limit (0 = none), with the
+ * solver backend of ctx.
+ */
+uint64_t sudoku_count_all_solutions(const SudokuContext *ctx,
+                                    const uint64_t limit);
+
+// Same as above, on the default context
+bool enumerate_begin(const uint64_t limit);
+uint32_t enumerate_next(uint8_t *out, const uint32_t capacity);
+uint64_t get_enumerated_count(void);
+bool is_enumeration_done(void);
+uint64_t count_all_solutions(const uint64_t limit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENUMERATE_H_
@@ -0,0 +1,107 @@
+#ifndef GENERATOR_H_
+#define GENERATOR_H_
+
+#include "rand.h"
+#include "search.h"
+#include "sudoku.h"
+#include <stdint.h>
+
+// Clue layouts. A clue is only removed together with the cells it maps to.
+typedef enum {
+  SYMMETRY_NONE,
+  SYMMETRY_ROTATE_180, // (x, y) and (8 - x, 8 - y)
+  SYMMETRY_ROTATE_90,  // the four quarter turns of (x, y)
+  SYMMETRY_MIRROR,     // (x, y) and (8 - x, y)
+} Symmetry;
+
+#define SYMMETRY_MAX_ORBIT 4
+
+// Removal passes before the generation fails, passes on one grid before the
+// next is drawn, and orbits put back between two passes on a grid
+#define GENERATOR_MAX_ATTEMPTS 4096
+#define GENERATOR_PASSES_PER_GRID 128
+#define GENERATOR_PERTURBATION 3
+
+/**
+ * Digits are removed until the puzzle is minimal: every clue is needed for a
+ * unique solution. With clues set to 0 any minimal puzzle is kept. Otherwise
+ * only minimal puzzles with exactly that many clues are produced: passes that
+ * miss the target put a few removed orbits of the closest puzzle back and
+ * remove digits again in a new order, and a fresh grid is drawn after
+ * GENERATOR_PASSES_PER_GRID passes. Under symmetry the reachable counts are
+ * limited by the orbit sizes, e.g. 4k or 4k + 1 clues for SYMMETRY_ROTATE_90.
+ */
+typedef struct {
+  Symmetry symmetry;
+  uint8_t clues;
+} GeneratorOptions;
+
+/**
+ * State of a puzzle generation that can be paused between any two search
+ * nodes. The grid search and then each uniqueness check run in search. The
+ * checks share the transposition table, so subtrees an earlier check already
+ * counted are not explored again. Removals that singles alone undo skip the
+ * search entirely.
+ */
+typedef struct {
+  Search search;
+  Rng *rng;
+  GeneratorOptions options;
+  uint8_t givens[BOARD_SIZE];
+  uint8_t solution[BOARD_SIZE];
+  uint8_t best[BOARD_SIZE]; // closest to the target of this grid's passes
+  uint8_t best_clues;
+  uint8_t order[BOARD_SIZE]; // first cell of each orbit, in removal order
+  uint8_t orbit_count;
+  uint8_t next;    // position in order, or the cell, being checked
+  uint8_t removed[SYMMETRY_MAX_ORBIT]; // cells emptied by the current check
+  uint8_t removed_count;
+  uint32_t needed[CELL_BITSET_WORDS]; // clues known to be necessary
+  uint8_t clues;
+  uint16_t attempts; // removal passes so far
+  uint8_t passes;    // removal passes on this grid
+  bool has_grid;
+  bool perturb;    // start the next pass on this grid at the next step
+  bool minimizing; // checking the clues one by one
+  TaskStatus status;
+} Generation;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Draws a random complete grid into solution and removes digits in random
+ * order, one orbit of the symmetry at a time, while the puzzle keeps a unique
+ * solution, see GeneratorOptions. givens receives the puzzle, BOARD_SIZE
+ * digits with CELL_VALUE_EMPTY blanks.
+ */
+bool generate_puzzle(Rng *rng, const GeneratorOptions *options,
+                     uint8_t *givens, uint8_t *solution);
+
+/** Starts a generate_puzzle() that is run with generation_step(). */
+void generation_begin(Generation *generation, Rng *rng,
+                      const GeneratorOptions *options);
+
+/**
+ * Explores at most max_nodes search nodes. On TASK_DONE givens and solution
+ * hold the puzzle. TASK_FAILED means none of GENERATOR_MAX_ATTEMPTS removal
+ * passes gave a minimal puzzle with the requested clue count.
+ */
+TaskStatus generation_step(Generation *generation, const uint64_t max_nodes);
+
+/**
+ * Sets the options used by every later sudoku_fill_random_board(),
+ * sudoku_prepare_random_board() and sudoku_generate_begin() of ctx.
+ */
+void sudoku_set_generator_options(SudokuContext *ctx, const Symmetry symmetry,
+                                  const uint8_t clues);
+
+// Same as above, on the default context
+void set_generator_options(const Symmetry symmetry, const uint8_t clues);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GENERATOR_H_
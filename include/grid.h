@@ -0,0 +1,35 @@
+#ifndef GRID_H_
+#define GRID_H_
+
+#include "rand.h"
+#include "search.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Fills values with a random complete grid, BOARD_SIZE digits. Digits are
+ * tried in an order drawn from rng at every branch, so each stream yields its
+ * own sequence of grids.
+ */
+bool generate_grid(Rng *rng, uint8_t *values);
+
+/**
+ * Prepares the search generate_grid() runs, for callers that drive it in
+ * slices. Its first solution is the grid.
+ */
+void grid_search_init(Search *search, Rng *rng);
+
+/**
+ * Writes count complete grids from the default generator to out, BOARD_SIZE
+ * digits each, and returns how many were written.
+ */
+uint32_t generate_grids(uint8_t *out, const uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GRID_H_
@@ -0,0 +1,64 @@
+#ifndef HINTS_H_
+#define HINTS_H_
+
+#include "sudoku.h"
+#include <stdint.h>
+
+#define HINT_MAX_TARGETS 4
+#define HINT_MAX_ELIMINATIONS 24
+#define HINT_NO_UNIT 0xFF
+
+// Ordered from the simplest technique to the hardest one, which is also the
+// order in which they are searched.
+typedef enum {
+  HINT_NONE,
+  HINT_NAKED_SINGLE,
+  HINT_HIDDEN_SINGLE,
+  HINT_POINTING,
+  HINT_BOX_LINE_REDUCTION,
+  HINT_NAKED_SUBSET,
+  HINT_HIDDEN_SUBSET,
+  HINT_X_WING,
+  HINT_XY_WING,
+} HintTechnique;
+
+typedef struct {
+  uint8_t technique;         // HintTechnique
+  uint8_t unit;              // supporting unit (see units.h) or HINT_NO_UNIT
+  uint8_t value;             // digit placed by a single or the pattern digit
+  uint8_t target_count;      // cells forming the pattern
+  uint8_t elimination_count; // entries in elimination_cells/masks
+  uint8_t alignment[3];
+  uint8_t targets[HINT_MAX_TARGETS];
+  uint8_t elimination_cells[HINT_MAX_ELIMINATIONS];
+  uint16_t elimination_masks[HINT_MAX_ELIMINATIONS]; // notes bit layout
+} Hint;
+
+// Per-context hint state, see find_next_step()
+typedef struct {
+  Hint hint;
+  uint16_t eliminated[BOARD_SIZE]; // candidates removed by earlier hints
+  uint32_t eliminated_epoch;       // candidate epoch eliminated belongs to
+} HintState;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Searches the board of ctx for the simplest applicable deduction.
+ *
+ * Singles report the cell to fill in targets[0] and the digit in value. Every
+ * other technique reports the candidates it removes. Those eliminations are
+ * remembered until a digit is removed from the board, so repeated calls walk
+ * through the deduction chain. Returns a record with technique HINT_NONE when
+ * nothing applies. The pointer stays valid until the next call.
+ */
+Hint *sudoku_find_next_step(SudokuContext *ctx);
+Hint *find_next_step(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HINTS_H_
@@ -0,0 +1,73 @@
+#ifndef JOURNAL_H_
+#define JOURNAL_H_
+
+#include "sudoku.h"
+#include <stdint.h>
+
+// Power of two so positions can be masked. A single operation never touches
+// more than BOARD_SIZE cells, so only a group that changes more cells than
+// this can lose the start of its own step.
+#define JOURNAL_CAPACITY 1024
+
+#define JOURNAL_STEP_START 0x01 // first entry of an undo step
+
+// Cell state byte: digit in the low nibble, then the locked and prefilled bits
+#define JOURNAL_CELL_LOCKED 0x10
+#define JOURNAL_CELL_PREFILLED 0x20
+#define JOURNAL_CELL_DIGIT 0x0f
+
+/** The change of one cell, applied backwards by undo and forwards by redo. */
+typedef struct {
+  uint8_t cell;
+  uint8_t flags; // JOURNAL_STEP_START
+  uint8_t old_state;
+  uint8_t new_state;
+  uint16_t old_notes;
+  uint16_t new_notes;
+} JournalEntry;
+
+/**
+ * Ring of cell changes. Positions only grow and wrap through the mask:
+ * [start, cursor) can be undone and [cursor, end) redone. A full ring drops
+ * its oldest step; recording after an undo drops the redo history.
+ */
+typedef struct {
+  JournalEntry entries[JOURNAL_CAPACITY];
+  uint32_t start;
+  uint32_t cursor;
+  uint32_t end;
+  uint8_t group_depth;
+  bool step_open; // entries join the current step instead of starting one
+} Journal;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void journal_clear(Journal *journal);
+
+/**
+ * Starts a new undo step, unless a group is open. Steps without entries are
+ * never stored. A group makes everything recorded until its end one step.
+ */
+void journal_begin_step(Journal *journal);
+void journal_begin_group(Journal *journal);
+void journal_end_group(Journal *journal);
+
+void journal_record(Journal *journal, JournalEntry entry);
+
+/**
+ * Moves the cursor over one step and returns its entries as the position
+ * range [*first, *last). Returns false when there is nothing to move over.
+ */
+bool journal_undo_step(Journal *journal, uint32_t *first, uint32_t *last);
+bool journal_redo_step(Journal *journal, uint32_t *first, uint32_t *last);
+
+const JournalEntry *journal_entry(const Journal *journal,
+                                  const uint32_t position);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JOURNAL_H_
@@ -7,7 +7,14 @@
 extern "C" {
 #endif
 
+/**
+ * Built with -mbulk-memory these lower to the memory.copy and memory.fill
+ * instructions, otherwise they copy and fill a word at a time whenever the
+ * pointers allow it.
+ */
 void *memcpy(void *destination, const void *source, size_t num);
+void *memmove(void *destination, const void *source, size_t num);
+void *memset(void *destination, int value, size_t num);
 
 #ifdef __cplusplus
 }
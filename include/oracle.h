@@ -0,0 +1,86 @@
+#ifndef ORACLE_H_
+#define ORACLE_H_
+
+#include "search.h"
+#include "sudoku.h"
+#include <stdint.h>
+
+// Verdict of sudoku_check_solvable()
+typedef enum {
+  SOLVABILITY_UNKNOWN,    // still checking, call again
+  SOLVABILITY_SOLVABLE,   // the board can still be completed
+  SOLVABILITY_UNSOLVABLE, // no completion exists, see the culprit entries
+} Solvability;
+
+typedef enum {
+  ORACLE_START,  // the board changed since the last verdict
+  ORACLE_CHECK,  // searching the whole board
+  ORACLE_LOCATE, // bisecting the entries for the first unsolvable prefix
+  ORACLE_SHRINK, // dropping the entries the conflict does not need
+  ORACLE_DONE,   // the verdict is up to date
+} OraclePhase;
+
+/**
+ * Per-context solvability check. Every move is reported through
+ * oracle_note_move(), which keeps the verdict without searching whenever it
+ * cannot have changed: a solvable board stays solvable while the moves agree
+ * with the solution found for it, and an unsolvable one while digits are only
+ * added. Otherwise the check restarts and runs in slices.
+ *
+ * Entries are the filled cells that are not givens, ordered by when they were
+ * made. An unsolvable board is blamed on the first entry after which it had no
+ * solution left, together with the earlier entries it conflicts with.
+ */
+typedef struct {
+  Solvability verdict;
+  OraclePhase phase;
+  Search search;
+
+  uint8_t witness[BOARD_SIZE]; // solution of the board while solvable
+  uint32_t stamps[BOARD_SIZE]; // when each cell was last written
+  uint32_t clock;
+
+  uint8_t entries[BOARD_SIZE]; // entries by stamp, while locating
+  uint8_t entry_count;
+  uint8_t low, high; // bisection bounds, then entries left to try and prefix
+  uint32_t dropped[CELL_BITSET_WORDS];
+  uint32_t culprits[CELL_BITSET_WORDS];
+} Oracle;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Forgets the verdict after the board was rewritten in bulk. */
+void oracle_reset(Oracle *oracle);
+
+/** Records that a cell changed from previous to value. */
+void oracle_note_move(Oracle *oracle, const uint8_t index,
+                      const SudokuValue previous, const SudokuValue value);
+
+/**
+ * Works out whether the board can still be completed, without using the
+ * stored solution, so it also covers puzzles entered by hand. Places at most
+ * max_nodes digits per call and returns SOLVABILITY_UNKNOWN until it is done;
+ * call it every frame, it returns at once while the verdict is up to date.
+ */
+Solvability sudoku_check_solvable(SudokuContext *ctx, const uint32_t max_nodes);
+Solvability sudoku_get_solvability(const SudokuContext *ctx);
+
+/**
+ * Cell bitset of the earliest entries that leave the board unsolvable, empty
+ * unless the verdict is SOLVABILITY_UNSOLVABLE. Also empty when the givens
+ * alone have no solution.
+ */
+const uint32_t *sudoku_get_unsolvable_entries(const SudokuContext *ctx);
+
+// Same as above, on the default context
+Solvability check_solvable(const uint32_t max_nodes);
+Solvability get_solvability(void);
+const uint32_t *get_unsolvable_entries(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ORACLE_H_
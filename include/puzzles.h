@@ -0,0 +1,25 @@
+#ifndef PUZZLES_H_
+#define PUZZLES_H_
+
+#include "sudoku.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of puzzles shipped in the binary. */
+uint32_t get_embedded_puzzle_count(void);
+
+/**
+ * Loads one of the shipped puzzles, which needs no search, so a board can be
+ * shown before the first puzzle is generated. Returns false for a bad index.
+ */
+bool sudoku_load_embedded_puzzle(SudokuContext *ctx, const uint32_t index);
+bool load_embedded_puzzle(const uint32_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PUZZLES_H_
@@ -3,14 +3,33 @@
 
 #include <stdint.h>
 
-extern uint32_t seed;
+/**
+ * PCG32 generator (XSH RR output over a 64-bit LCG). Generators seeded with
+ * different streams never share a sequence, so a puzzle can be identified by a
+ * (seed, stream) pair and regenerated from it.
+ */
+typedef struct {
+  uint64_t state;
+  uint64_t increment; // odd, selects the stream
+} Rng;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-uint32_t lcg(void);
+void rng_seed(Rng *rng, const uint64_t seed, const uint64_t stream);
+uint32_t rng_next(Rng *rng);
 
+/** Returns a uniformly distributed value in [0, bound), bound > 0. */
+uint32_t rng_bounded(Rng *rng, const uint32_t bound);
+
+/** Skips DELTA outputs in O(log DELTA). */
+void rng_advance(Rng *rng, uint64_t delta);
+
+/** The generator used by the board generator. */
+Rng *get_rng(void);
+
+/** Returns a value in [min, max] from the default generator. */
 int32_t random(const int32_t min, const int32_t max);
 
 #ifdef __cplusplus
@@ -0,0 +1,77 @@
+#ifndef SEARCH_H_
+#define SEARCH_H_
+
+#include "rand.h"
+#include "sudoku.h"
+#include <stdint.h>
+
+typedef enum {
+  SEARCH_SOLUTION,  // values holds a solution, call again to continue
+  SEARCH_EXHAUSTED, // every branch has been explored
+  SEARCH_PAUSED,    // the node budget ran out, call again to resume
+} SearchResult;
+
+typedef struct {
+  uint8_t cell;
+  uint8_t solutions;  // below this frame, counting searches only
+  uint16_t remaining; // digits not tried yet
+} SearchFrame;
+
+/**
+ * Resumable depth-first search over bitmask candidates. The whole state,
+ * including the explicit stack, lives in the struct so a search can be paused
+ * at any node and continued later.
+ */
+typedef struct {
+  uint8_t values[BOARD_SIZE];
+  uint16_t rows[BOARD_SIDE_LENGTH];
+  uint16_t cols[BOARD_SIDE_LENGTH];
+  uint16_t boxes[BOARD_SIDE_LENGTH];
+  SearchFrame stack[BOARD_SIZE];
+  uint8_t depth;
+  bool descend;
+  bool exhausted;
+  uint64_t nodes;    // digits placed so far
+  Rng *rng;          // when set, digits are tried in random order
+  uint64_t hash;     // Zobrist hash of values, see transposition.h
+  uint8_t solutions; // counted by search_count_next()
+  bool traced;       // records its steps, only set for sudoku_solve_begin()
+} Search;
+
+#define SEARCH_UNBOUNDED UINT64_MAX
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Prepares a search from BOARD_SIZE values (CELL_VALUE_EMPTY for blanks) that
+ * tries digits in ascending order.
+ * Returns false, with the search already exhausted, if the givens repeat a
+ * digit in a unit.
+ */
+bool search_init(Search *search, const uint8_t *values);
+
+/** Explores at most max_nodes placements looking for the next solution. */
+SearchResult search_next(Search *search, const uint64_t max_nodes);
+
+/**
+ * Counting version of search_next() for uniqueness checks. Explores at most
+ * max_nodes placements and returns SEARCH_PAUSED, or SEARCH_EXHAUSTED once
+ * solutions holds the solution count capped at TRANSPOSITION_COUNT_CAP.
+ * Subtrees whose count is in the transposition table are skipped, and every
+ * finished subtree is added to it.
+ */
+SearchResult search_count_next(Search *search, const uint64_t max_nodes);
+
+/**
+ * Counts the solutions of values, stopping at limit (0 = none). Limits up to
+ * TRANSPOSITION_COUNT_CAP use search_count_next().
+ */
+uint64_t search_count(const uint8_t *values, const uint64_t limit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEARCH_H_
@@ -0,0 +1,69 @@
+#ifndef SERIALIZE_H_
+#define SERIALIZE_H_
+
+#include "sudoku.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define STATE_FORMAT_VERSION 1
+
+#define STATE_VERSION_BITS 4
+
+// Bits per cell: kind, notes flag, then the digit and notes when present
+#define STATE_CELL_KIND_BITS 2
+#define STATE_DIGIT_BITS 4
+#define STATE_NOTES_BITS CELL_VALUE_MAX
+#define STATE_CELL_MAX_BITS                                                    \
+  (STATE_CELL_KIND_BITS + 1 + STATE_DIGIT_BITS + STATE_NOTES_BITS)
+
+// Largest blob, every cell filled and annotated
+#define STATE_MAX_SIZE                                                         \
+  ((STATE_VERSION_BITS + BOARD_SIZE * STATE_CELL_MAX_BITS + 7) / 8)
+
+// Unpadded base64url of STATE_MAX_SIZE bytes
+#define STATE_TEXT_MAX_LENGTH ((STATE_MAX_SIZE * 4 + 2) / 3)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Packs the board of ctx (givens, entries, locked flags and notes) into out
+ * and returns the number of bytes written, at most STATE_MAX_SIZE, or 0 if
+ * capacity is too small. The solution is not stored; it is recomputed on
+ * decoding.
+ *
+ * Layout, least significant bit first: a 4-bit version, then for each cell a
+ * 2-bit kind (empty, given, entry, locked entry), a 1-bit notes flag, the
+ * 4-bit digit of non-empty cells and the 9-bit notes of annotated cells.
+ */
+size_t sudoku_encode_state(const SudokuContext *ctx, uint8_t *out,
+                           const size_t capacity);
+
+/**
+ * Replaces the board of ctx with an encoded state. Leaves ctx untouched and
+ * returns false if the data is malformed or its givens have no solution.
+ */
+bool sudoku_decode_state(SudokuContext *ctx, const uint8_t *data,
+                         const size_t size);
+
+/**
+ * Same as sudoku_encode_state() as unpadded base64url text, at most
+ * STATE_TEXT_MAX_LENGTH characters and not NUL-terminated.
+ */
+size_t sudoku_encode_state_text(const SudokuContext *ctx, char *out,
+                                const size_t capacity);
+bool sudoku_decode_state_text(SudokuContext *ctx, const char *text,
+                              const size_t length);
+
+// Same as above, on the default context
+size_t encode_state(uint8_t *out, const size_t capacity);
+bool decode_state(const uint8_t *data, const size_t size);
+size_t encode_state_text(char *out, const size_t capacity);
+bool decode_state_text(const char *text, const size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SERIALIZE_H_
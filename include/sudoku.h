@@ -1,6 +1,7 @@
 #ifndef SUDOKU_H_
 #define SUDOKU_H_
 
+#include "arena.h"
 #include <stddef.h>
 #include <stdint.h>
 
@@ -29,35 +30,216 @@ typedef struct {
 #define SUDOKU_CELL(x, y, num, pref)                                           \
   (SudokuCell){(x), (y), (num), (pref), 0, 0, 0}
 
-extern SudokuCell board[BOARD_SIZE];
-extern SudokuCell solved_board[BOARD_SIZE];
-
 #define STACK_SIZE (BOARD_SIZE * 10)
-extern SudokuCell stack[STACK_SIZE];
+
+// Backs the per-operation solver and generator state
+#define SCRATCH_ARENA_SIZE (128 * 1024)
+
+// Cell bitsets use one bit per cell, cell index i lives in word i / 32, bit
+// i % 32.
+#define CELL_BITSET_WORDS ((BOARD_SIZE + 31) / 32)
+
+typedef struct {
+  uint32_t values[CELL_BITSET_WORDS]; // value, prefilled or locked changed
+  uint32_t notes[CELL_BITSET_WORDS];  // notes mask changed
+} DirtyCells;
+
+// Progress of the resumable solver and generator
+typedef enum {
+  TASK_IDLE,    // not started or cancelled
+  TASK_RUNNING, // call step again
+  TASK_DONE,
+  TASK_FAILED,
+} TaskStatus;
+
+// Algorithm behind sudoku_solve() and sudoku_count_all_solutions()
+typedef enum {
+  SOLVER_BACKTRACK, // depth-first search, the default
+  SOLVER_CDCL,      // clause learning, see cdcl.h
+} SolverBackend;
+
+/** One independent game, see context.h. */
+typedef struct SudokuContext SudokuContext;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-SudokuCell *get_board(void);
-SudokuCell *get_solved_board(void);
+Arena *get_scratch_arena(void);
+size_t get_scratch_arena_capacity(void);
+size_t get_scratch_arena_high_water(void);
+
+/**
+ * Allocates a context with an empty board and a generator stream of its own.
+ * Returns NULL when out of memory.
+ */
+SudokuContext *sudoku_create(void);
+void sudoku_destroy(SudokuContext *ctx);
+
+/** The context used by the functions that do not take one. */
+SudokuContext *get_default_context(void);
+
+/** Seeds the generator of ctx, see rng_seed(). */
+void sudoku_seed(SudokuContext *ctx, const uint64_t seed,
+                 const uint64_t stream);
+
 uint8_t get_board_size(void);
 uint8_t get_board_side_length(void);
 uint8_t get_board_index(const uint8_t x, const uint8_t y);
-SudokuValue get_board_value(const uint8_t x, const uint8_t y);
 
+SudokuCell *sudoku_get_board(SudokuContext *ctx);
+SudokuCell *sudoku_get_solved_board(SudokuContext *ctx);
+SudokuValue sudoku_get_board_value(const SudokuContext *ctx, const uint8_t x,
+                                   const uint8_t y);
+
+bool sudoku_set_board_value(SudokuContext *ctx, const SudokuValue value,
+                            const uint8_t x, const uint8_t y, bool prefilled);
+bool sudoku_solve(SudokuContext *ctx);
+
+/**
+ * Picks the solver used by sudoku_solve() and sudoku_count_all_solutions().
+ * SOLVER_CDCL learns from dead ends, which bounds the time spent on puzzles
+ * built against backtracking. The resumable solver always backtracks.
+ */
+void sudoku_set_solver_backend(SudokuContext *ctx,
+                               const SolverBackend backend);
+SolverBackend sudoku_get_solver_backend(const SudokuContext *ctx);
+
+/**
+ * Resumable version of sudoku_solve(). sudoku_solve_begin() snapshots the
+ * board, then every sudoku_solve_step() places at most max_nodes digits. On
+ * TASK_DONE the solution is in solved_board. Stopping or beginning again
+ * between steps abandons the solve.
+ */
+bool sudoku_solve_begin(SudokuContext *ctx);
+TaskStatus sudoku_solve_step(SudokuContext *ctx, const uint32_t max_nodes);
+TaskStatus sudoku_get_solve_status(const SudokuContext *ctx);
+
+bool sudoku_is_correct_attempt(const SudokuContext *ctx,
+                               const SudokuValue value, const uint8_t x,
+                               const uint8_t y);
+bool sudoku_is_board_solved(SudokuContext *ctx);
+
+void sudoku_reset_board(SudokuContext *ctx);
+void sudoku_fill_test_board(SudokuContext *ctx);
+void sudoku_fill_random_board(SudokuContext *ctx);
+
+/**
+ * Replaces the board with a puzzle. givens and solution hold BOARD_SIZE digits
+ * each; the non-empty givens become prefilled cells.
+ */
+void sudoku_load_board(SudokuContext *ctx, const uint8_t *givens,
+                       const uint8_t *solution);
+
+/**
+ * Generates a puzzle without touching the board, so that it can be done in
+ * idle time and shown later with sudoku_load_prepared_board(). When no puzzle
+ * matches the generator options, the default options are used instead, here
+ * and in sudoku_fill_random_board().
+ */
+bool sudoku_prepare_random_board(SudokuContext *ctx);
+
+/** Loads the prepared puzzle. Returns false if there is none. */
+bool sudoku_load_prepared_board(SudokuContext *ctx);
+
+/**
+ * Resumable version of sudoku_prepare_random_board(), see sudoku_solve_step().
+ * On TASK_DONE the puzzle is ready for sudoku_load_prepared_board(). Draws the
+ * same puzzle from the same generator state.
+ */
+void sudoku_generate_begin(SudokuContext *ctx);
+TaskStatus sudoku_generate_step(SudokuContext *ctx, const uint32_t max_nodes);
+TaskStatus sudoku_get_generate_status(const SudokuContext *ctx);
+
+bool sudoku_set_cell_note(SudokuContext *ctx, const bool on,
+                          const uint16_t note, const uint8_t x,
+                          const uint8_t y);
+bool sudoku_toggle_cell_note(SudokuContext *ctx, const uint16_t note,
+                             const uint8_t x, const uint8_t y);
+bool sudoku_reset_cell_notes(SudokuContext *ctx, const uint8_t x,
+                             const uint8_t y);
+int16_t sudoku_get_cell_notes(const SudokuContext *ctx, const uint8_t x,
+                              const uint8_t y);
+bool sudoku_get_cell_note(const SudokuContext *ctx, const uint16_t note,
+                          const uint8_t x, const uint8_t y);
+bool sudoku_set_cell_notes(SudokuContext *ctx, const uint16_t notes,
+                           const uint8_t x, const uint8_t y);
+void sudoku_cleanup_invalid_notes(SudokuContext *ctx, const uint8_t x,
+                                  const uint8_t y);
+
+/** Replaces the notes of every cell with its legal candidates. */
+void sudoku_auto_fill_notes(SudokuContext *ctx);
+
+/**
+ * Read-only view of the legal candidates of every cell, one 9-bit mask per
+ * cell using the same bit layout as the notes. Filled cells have no candidates.
+ */
+const uint16_t *sudoku_get_candidates(SudokuContext *ctx);
+
+/**
+ * Changes whenever a candidate may have been added back, i.e. a digit was
+ * removed or the board was rewritten. Deductions made on the candidates stay
+ * valid while the epoch is unchanged.
+ */
+uint32_t sudoku_get_candidate_epoch(const SudokuContext *ctx);
+
+/**
+ * Cell bitset of the filled cells whose digit also appears in one of their
+ * peers. Does not need a solved board.
+ */
+const uint32_t *sudoku_get_conflicts(SudokuContext *ctx);
+uint8_t sudoku_get_conflict_count(SudokuContext *ctx);
+
+/** True when every cell is filled and no cell conflicts with a peer. */
+bool sudoku_is_board_complete(SudokuContext *ctx);
+
+/**
+ * Returns the cells modified since the previous call and clears the live set.
+ * The returned pointer stays valid until the next call.
+ */
+DirtyCells *sudoku_take_dirty_cells(SudokuContext *ctx);
+
+/**
+ * Reverts the last step of the undo journal, or reapplies the last reverted
+ * one. Every operation that edits cells in place is one step: the journal
+ * keeps the old and new digit, locked flag and notes of each cell it changed,
+ * so neither needs a snapshot or a solve. Changed cells are reported through
+ * sudoku_take_dirty_cells(). Loading a board clears the journal. Returns false
+ * when there is nothing to undo or redo.
+ */
+bool sudoku_undo(SudokuContext *ctx);
+bool sudoku_redo(SudokuContext *ctx);
+bool sudoku_can_undo(const SudokuContext *ctx);
+bool sudoku_can_redo(const SudokuContext *ctx);
+
+/** Makes every change until the matching end one undo step. Groups nest. */
+void sudoku_begin_undo_group(SudokuContext *ctx);
+void sudoku_end_undo_group(SudokuContext *ctx);
+
+// Same as above, on the default context
+SudokuCell *get_board(void);
+SudokuCell *get_solved_board(void);
+SudokuValue get_board_value(const uint8_t x, const uint8_t y);
 bool set_board_value(const SudokuValue value, const uint8_t x, const uint8_t y,
                      bool prefilled);
 bool solve_sudoku(void);
-
+void set_solver_backend(const SolverBackend backend);
+SolverBackend get_solver_backend(void);
+bool solve_begin(void);
+TaskStatus solve_step(const uint32_t max_nodes);
+TaskStatus get_solve_status(void);
 bool is_correct_attempt(const SudokuValue value, const uint8_t x,
                         const uint8_t y);
 bool is_board_solved();
-
 void reset_board(void);
 void fill_test_board(void);
 void fill_random_board(void);
-
+void load_board(const uint8_t *givens, const uint8_t *solution);
+bool prepare_random_board(void);
+bool load_prepared_board(void);
+void generate_begin(void);
+TaskStatus generate_step(const uint32_t max_nodes);
+TaskStatus get_generate_status(void);
 bool set_cell_note(const bool on, const uint16_t note, const uint8_t x,
                    const uint8_t y);
 bool toggle_cell_note(const uint16_t note, const uint8_t x, const uint8_t y);
@@ -66,6 +248,19 @@ int16_t get_cell_notes(const uint8_t x, const uint8_t y);
 bool get_cell_note(const uint16_t note, const uint8_t x, const uint8_t y);
 bool set_cell_notes(const uint16_t notes, const uint8_t x, const uint8_t y);
 void cleanup_invalid_notes(const uint8_t x, const uint8_t y);
+void auto_fill_notes(void);
+const uint16_t *get_candidates(void);
+uint32_t get_candidate_epoch(void);
+const uint32_t *get_conflicts(void);
+uint8_t get_conflict_count(void);
+bool is_board_complete(void);
+DirtyCells *take_dirty_cells(void);
+bool undo(void);
+bool redo(void);
+bool can_undo(void);
+bool can_redo(void);
+void begin_undo_group(void);
+void end_undo_group(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,87 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+
+typedef enum {
+  TRACE_PLACE,     // a digit was tried in a cell with several candidates
+  TRACE_PROPAGATE, // a cell's only candidate was placed
+  TRACE_REMOVE,    // a digit was taken back to try the next one
+  TRACE_BACKTRACK, // every digit of a cell failed, the search steps back
+} TraceEventKind;
+
+typedef struct {
+  uint8_t kind; // TraceEventKind
+  uint8_t cell;
+  uint8_t digit; // CELL_VALUE_EMPTY for TRACE_BACKTRACK
+  uint8_t depth; // search depth, saturated at 255
+} TraceEvent;
+
+// Power of two so the ring position is a mask
+#define TRACE_CAPACITY 4096
+
+/**
+ * Only built with -DSUDOKU_TRACE=ON, otherwise TRACE() expands to nothing.
+ * Ring of events not read yet. head and tail only grow; events live at
+ * position & (TRACE_CAPACITY - 1). When the ring is full new events are
+ * counted in dropped and discarded, so a reader always sees a prefix of the
+ * search.
+ */
+typedef struct {
+  TraceEvent events[TRACE_CAPACITY];
+  uint32_t head;
+  uint32_t tail;
+  uint32_t dropped;
+  bool enabled;
+} TraceRing;
+
+#ifdef SUDOKU_TRACE
+extern TraceRing trace_ring;
+
+static inline void trace_record(const TraceEventKind kind, const uint8_t cell,
+                                const uint8_t digit, const uint32_t depth) {
+  if (!trace_ring.enabled)
+    return;
+
+  if (trace_ring.head - trace_ring.tail >= TRACE_CAPACITY) {
+    trace_ring.dropped++;
+    return;
+  }
+
+  trace_ring.events[trace_ring.head++ & (TRACE_CAPACITY - 1)] =
+      (TraceEvent){kind, cell, digit, depth > 0xff ? 0xff : depth};
+}
+
+#define TRACE(kind, cell, digit, depth)                                        \
+  trace_record((kind), (cell), (digit), (depth))
+#else
+#define TRACE(kind, cell, digit, depth) ((void)0)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** True when the module was built with -DSUDOKU_TRACE=ON. */
+bool is_trace_available(void);
+
+/** Starts or stops recording. Recording is off until enabled. */
+void trace_set_enabled(const bool enabled);
+
+/**
+ * Moves up to capacity of the oldest unread events to out and returns how
+ * many were moved.
+ */
+uint32_t trace_read(TraceEvent *out, const uint32_t capacity);
+
+/** Events discarded because the ring was full. */
+uint32_t get_trace_dropped(void);
+
+/** Discards every unread event and resets the drop count. */
+void trace_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRACE_H_
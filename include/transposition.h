@@ -0,0 +1,69 @@
+#ifndef TRANSPOSITION_H_
+#define TRANSPOSITION_H_
+
+#include "sudoku.h"
+#include <stdint.h>
+
+// Solution counts are only told apart up to this many, enough to tell a
+// unique puzzle from one with several solutions
+#define TRANSPOSITION_COUNT_CAP 2
+
+// log2 of the number of 8-byte entries. Off by default, uniqueness checks
+// rarely meet the same board twice (see the README).
+#define TRANSPOSITION_DEFAULT_BITS 0
+#define TRANSPOSITION_MAX_BITS 24
+
+/**
+ * Zobrist keys, one per cell and digit (index 0 is unused and zero). The hash
+ * of a partial board is the XOR of the keys of its digits, so placing or
+ * removing a digit updates it with one XOR.
+ */
+extern uint64_t zobrist_keys[BOARD_SIZE][CELL_VALUE_MAX + 1];
+
+/**
+ * Capped solution counts of partial boards, shared by every search. Each
+ * entry is the board hash with its low two bits replaced by count + 1, so 0
+ * marks an empty slot. A colliding board simply overwrites its slot.
+ */
+typedef struct {
+  uint64_t *entries;
+  uint8_t bits; // 0 disables the table
+  uint64_t probes;
+  uint64_t hits;
+  uint64_t stores;
+} TranspositionTable;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Fills zobrist_keys on the first call. */
+void zobrist_init(void);
+
+/**
+ * Looks up the solution count of the board with hash key, capped at
+ * TRANSPOSITION_COUNT_CAP. Always misses while the table is off.
+ */
+bool transposition_probe(const uint64_t key, uint8_t *count);
+void transposition_store(const uint64_t key, const uint8_t count);
+
+/**
+ * Reallocates the table with 2^bits entries, at most TRANSPOSITION_MAX_BITS,
+ * dropping every entry. 0 turns caching off. Returns false, with caching off,
+ * when out of memory.
+ */
+bool set_transposition_table_bits(const uint8_t bits);
+uint8_t get_transposition_table_bits(void);
+
+/** Empties the table and resets the statistics below. */
+void clear_transposition_table(void);
+
+uint64_t get_transposition_probes(void);
+uint64_t get_transposition_hits(void);
+uint64_t get_transposition_stores(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRANSPOSITION_H_
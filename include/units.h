@@ -0,0 +1,39 @@
+#ifndef UNITS_H_
+#define UNITS_H_
+
+#include "sudoku.h"
+#include <stdint.h>
+
+// Units are numbered rows first, then columns, then boxes.
+#define UNIT_COUNT (BOARD_SIDE_LENGTH * 3)
+#define UNITS_PER_CELL 3
+#define PEER_COUNT                                                             \
+  ((BOARD_SIDE_LENGTH - 1) * 2 + (BOX_SIZE - 1) * (BOX_SIZE - 1))
+
+#define ROW_UNIT(y) (y)
+#define COL_UNIT(x) (BOARD_SIDE_LENGTH + (x))
+#define BOX_UNIT(b) (BOARD_SIDE_LENGTH * 2 + (b))
+
+#define DIGIT_MASK(value) ((uint16_t)(1u << ((value) - 1)))
+#define ALL_DIGITS_MASK ((uint16_t)((1u << CELL_VALUE_MAX) - 1))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Returns the BOARD_SIDE_LENGTH cell indices of a unit, in reading order. */
+const uint8_t *get_unit_cells(const uint8_t unit);
+
+/** Returns the row, column and box unit of a cell, in that order. */
+const uint8_t *get_cell_units(const uint8_t index);
+
+/** Returns the PEER_COUNT cells sharing a unit with a cell. */
+const uint8_t *get_cell_peers(const uint8_t index);
+
+uint8_t get_box_index(const uint8_t x, const uint8_t y);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UNITS_H_
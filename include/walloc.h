@@ -3,6 +3,20 @@
 
 #include <stddef.h>
 
+// Small objects are 8, 16, 24, 32, 40, 48, 64, 80, 128 and 256 bytes.
+#define WALLOC_SMALL_OBJECT_CLASSES 10
+
+struct walloc_stats {
+  size_t heap_bytes; // memory owned by walloc, including page headers
+  size_t small_object_bytes[WALLOC_SMALL_OBJECT_CLASSES]; // in use
+  size_t large_object_bytes;                              // in use
+  size_t free_large_objects;
+  size_t largest_free_large_object; // payload bytes
+  size_t memory_grow_calls;
+  size_t coalesced_large_objects; // merges of adjacent free large objects
+  size_t released_small_object_chunks; // empty chunks given back to the pool
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -10,6 +24,19 @@ extern "C" {
 void *malloc(size_t size);
 void free(void *ptr);
 
+/**
+ * Fills and returns a static snapshot of the allocator state. Walks the large
+ * object freelist, so it is meant for diagnostics rather than hot paths.
+ */
+const struct walloc_stats *walloc_get_stats(void);
+
+/**
+ * Returns every small object chunk with no live objects to the large object
+ * pool. This also happens on its own when large objects are allocated, except
+ * that one empty chunk per size class is kept.
+ */
+void walloc_trim(void);
+
 #ifdef __cplusplus
 }
 #endif
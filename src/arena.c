@@ -0,0 +1,44 @@
+#include "arena.h"
+#include "walloc.h"
+
+static inline size_t align_size(const size_t size) {
+  return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+bool arena_init(Arena *arena, const size_t capacity) {
+  arena->base = malloc(capacity);
+  arena->capacity = arena->base ? capacity : 0;
+  arena->offset = 0;
+  arena->high_water = 0;
+
+  return arena->base != NULL;
+}
+
+void arena_release(Arena *arena) {
+  free(arena->base);
+  arena->base = NULL;
+  arena->capacity = 0;
+  arena->offset = 0;
+}
+
+void *arena_alloc(Arena *arena, const size_t size) {
+  const size_t aligned = align_size(size);
+  if (aligned > arena->capacity - arena->offset)
+    return NULL;
+
+  void *ptr = arena->base + arena->offset;
+  arena->offset += aligned;
+  if (arena->offset > arena->high_water)
+    arena->high_water = arena->offset;
+
+  return ptr;
+}
+
+size_t arena_mark(const Arena *arena) { return arena->offset; }
+
+void arena_rewind(Arena *arena, const size_t mark) {
+  if (mark < arena->offset)
+    arena->offset = mark;
+}
+
+void arena_reset(Arena *arena) { arena->offset = 0; }
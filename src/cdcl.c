@@ -0,0 +1,614 @@
+#include "cdcl.h"
+#include "arena.h"
+#include "log.h"
+#include "memory.h"
+#include "units.h"
+
+#define NO_WATCH UINT16_MAX
+#define NO_VARIABLE UINT16_MAX
+#define NO_CONFLICT UINT32_MAX
+
+// Reasons are a clause index, a decision (or a fact at level 0), or an "at
+// most one" exclusion: REASON_EXCLUSION | the variable that is true. Conflicts
+// between two true variables v and w are REASON_EXCLUSION | v << 16 | w.
+#define REASON_DECISION UINT32_MAX
+#define REASON_EXCLUSION 0x80000000u
+
+#define ACTIVITY_DECAY 0.95f
+#define ACTIVITY_LIMIT 1e20f
+
+static inline uint16_t positive(const uint16_t variable) {
+  return variable << 1;
+}
+
+static inline uint16_t negative(const uint16_t variable) {
+  return variable << 1 | 1;
+}
+
+static inline uint8_t literal_value(const Cdcl *cdcl, const uint16_t literal) {
+  const uint8_t value = cdcl->assignment[literal >> 1];
+  return value == CDCL_UNASSIGNED ? value : value ^ (literal & 1);
+}
+
+static void assign(Cdcl *cdcl, const uint16_t literal, const uint32_t reason) {
+  const uint16_t variable = literal >> 1;
+  cdcl->assignment[variable] = !(literal & 1);
+  cdcl->level[variable] = cdcl->decision_level;
+  cdcl->reason[variable] = reason;
+  cdcl->trail[cdcl->trail_size++] = literal;
+}
+
+static void backtrack(Cdcl *cdcl, const uint16_t level) {
+  if (cdcl->decision_level <= level)
+    return;
+
+  const uint16_t start = cdcl->level_start[level + 1];
+  for (uint16_t i = cdcl->trail_size; i-- > start;) {
+    const uint16_t variable = cdcl->trail[i] >> 1;
+    cdcl->phase[variable] = cdcl->assignment[variable];
+    cdcl->assignment[variable] = CDCL_UNASSIGNED;
+  }
+
+  cdcl->trail_size = start;
+  cdcl->propagated = start;
+  cdcl->decision_level = level;
+}
+
+// Clauses
+
+static inline bool has_room(const Cdcl *cdcl, const uint16_t size) {
+  return cdcl->clause_count < CDCL_MAX_CLAUSES &&
+         CDCL_POOL_SIZE - cdcl->pool_size >= size;
+}
+
+static void watch(Cdcl *cdcl, const uint16_t clause, const uint8_t position) {
+  const uint16_t literal = cdcl->pool[cdcl->clause_start[clause] + position];
+  const uint16_t entry = clause * 2 + position;
+  cdcl->watch_next[entry] = cdcl->watch_head[literal];
+  cdcl->watch_head[literal] = entry;
+}
+
+// Clauses that are never dropped may fill half of the storage, so learning
+// always has room to work with.
+static bool has_blocking_room(const Cdcl *cdcl, const uint16_t size) {
+  uint32_t literals = size;
+  uint16_t clauses = 1;
+  for (uint16_t clause = 0; clause < cdcl->clause_count; ++clause) {
+    if (cdcl->clause_lbd[clause] == 0) {
+      literals += cdcl->clause_size[clause];
+      clauses++;
+    }
+  }
+
+  return literals <= CDCL_POOL_SIZE / 2 && clauses <= CDCL_MAX_CLAUSES / 2;
+}
+
+// Stores a clause of at least two literals, watching the first two. Check
+// has_room() first.
+static uint16_t add_clause(Cdcl *cdcl, const uint16_t *literals,
+                           const uint16_t size, const uint8_t lbd) {
+  const uint16_t clause = cdcl->clause_count++;
+  cdcl->clause_start[clause] = cdcl->pool_size;
+  cdcl->clause_size[clause] = size;
+  cdcl->clause_lbd[clause] = lbd;
+
+  memcpy(cdcl->pool + cdcl->pool_size, literals, size * sizeof(uint16_t));
+  cdcl->pool_size += size;
+
+  watch(cdcl, clause, 0);
+  watch(cdcl, clause, 1);
+  return clause;
+}
+
+// Keeps the half of the learned clauses with the lowest LBD, and among
+// clauses with the cutoff LBD the newest ones, then strips what the level 0
+// facts decide from them. Only called at level 0 with everything propagated,
+// so every kept clause still has two unassigned literals to watch.
+static void reduce(Cdcl *cdcl) {
+  uint16_t histogram[UINT8_MAX + 1] = {0};
+  uint16_t learned = 0;
+  for (uint16_t clause = 0; clause < cdcl->clause_count; ++clause) {
+    if (cdcl->clause_lbd[clause]) {
+      histogram[cdcl->clause_lbd[clause]]++;
+      learned++;
+    }
+  }
+
+  // Every clause below the cutoff fits in half, the cutoff's ones do not all
+  uint8_t cutoff = 1;
+  uint16_t below = 0;
+  while (cutoff < UINT8_MAX && below + histogram[cutoff] <= learned / 2) {
+    below += histogram[cutoff++];
+  }
+  const uint16_t keep_at_cutoff = learned / 2 - below;
+  const uint16_t drop_at_cutoff = histogram[cutoff] > keep_at_cutoff
+                                      ? histogram[cutoff] - keep_at_cutoff
+                                      : 0;
+
+  for (uint16_t i = 0; i < CDCL_LITERALS; ++i) {
+    cdcl->watch_head[i] = NO_WATCH;
+  }
+
+  const uint16_t count = cdcl->clause_count;
+  uint16_t dropped_at_cutoff = 0;
+  cdcl->clause_count = 0;
+  cdcl->pool_size = 0;
+
+  // Clauses are stored oldest first, which compacting preserves
+  for (uint16_t clause = 0; clause < count; ++clause) {
+    const uint8_t lbd = cdcl->clause_lbd[clause];
+    if (lbd > cutoff)
+      continue;
+    if (lbd == cutoff && dropped_at_cutoff < drop_at_cutoff) {
+      dropped_at_cutoff++;
+      continue;
+    }
+
+    // Compacts in place, the write position never passes the read position
+    const uint16_t *literals = cdcl->pool + cdcl->clause_start[clause];
+    uint16_t *out = cdcl->pool + cdcl->pool_size;
+    uint16_t size = 0;
+    bool satisfied = false;
+
+    for (uint16_t i = 0; i < cdcl->clause_size[clause] && !satisfied; ++i) {
+      const uint8_t value = literal_value(cdcl, literals[i]);
+      satisfied = value == CDCL_TRUE;
+      if (value == CDCL_UNASSIGNED)
+        out[size++] = literals[i];
+    }
+
+    if (satisfied)
+      continue;
+
+    const uint16_t kept = cdcl->clause_count++;
+    cdcl->clause_start[kept] = cdcl->pool_size;
+    cdcl->clause_size[kept] = size;
+    cdcl->clause_lbd[kept] = lbd;
+    cdcl->pool_size += size;
+    watch(cdcl, kept, 0);
+    watch(cdcl, kept, 1);
+  }
+
+  // Clause indices changed, and level 0 reasons are never read again
+  for (uint16_t i = 0; i < cdcl->trail_size; ++i) {
+    cdcl->reason[cdcl->trail[i] >> 1] = REASON_DECISION;
+  }
+}
+
+// Propagation
+
+// Sets every variable sharing a cell or a unit digit with variable to false.
+static uint32_t exclude(Cdcl *cdcl, const uint16_t variable) {
+  const uint8_t cell = variable / CELL_VALUE_MAX;
+  const uint8_t digit = variable % CELL_VALUE_MAX;
+  const uint32_t reason = REASON_EXCLUSION | variable;
+  const uint8_t *peers = get_cell_peers(cell);
+
+  for (uint8_t i = 0; i < CELL_VALUE_MAX - 1 + PEER_COUNT; ++i) {
+    const uint16_t other =
+        i < CELL_VALUE_MAX - 1
+            ? cell * CELL_VALUE_MAX + (i < digit ? i : i + 1)
+            : peers[i - (CELL_VALUE_MAX - 1)] * CELL_VALUE_MAX + digit;
+
+    switch (cdcl->assignment[other]) {
+    case CDCL_TRUE:
+      return REASON_EXCLUSION | (uint32_t)variable << 16 | other;
+    case CDCL_UNASSIGNED:
+      assign(cdcl, negative(other), reason);
+      break;
+    }
+  }
+
+  return NO_CONFLICT;
+}
+
+// Visits the clauses watching false_literal, which just became false.
+static uint32_t propagate_clauses(Cdcl *cdcl, const uint16_t false_literal) {
+  uint16_t *link = &cdcl->watch_head[false_literal];
+
+  while (*link != NO_WATCH) {
+    const uint16_t entry = *link;
+    const uint16_t clause = entry >> 1;
+    const uint8_t position = entry & 1;
+    uint16_t *literals = cdcl->pool + cdcl->clause_start[clause];
+    const uint16_t other = literals[!position];
+
+    if (literal_value(cdcl, other) == CDCL_TRUE) {
+      link = &cdcl->watch_next[entry];
+      continue;
+    }
+
+    // Watch another literal that is not false, if there is one
+    bool moved = false;
+    for (uint16_t i = 2; i < cdcl->clause_size[clause]; ++i) {
+      if (literal_value(cdcl, literals[i]) == CDCL_FALSE)
+        continue;
+
+      literals[position] = literals[i];
+      literals[i] = false_literal;
+      *link = cdcl->watch_next[entry];
+      cdcl->watch_next[entry] = cdcl->watch_head[literals[position]];
+      cdcl->watch_head[literals[position]] = entry;
+      moved = true;
+      break;
+    }
+
+    if (moved)
+      continue;
+
+    if (literal_value(cdcl, other) == CDCL_FALSE)
+      return clause;
+
+    assign(cdcl, other, clause);
+    link = &cdcl->watch_next[entry];
+  }
+
+  return NO_CONFLICT;
+}
+
+static uint32_t propagate(Cdcl *cdcl) {
+  while (cdcl->propagated < cdcl->trail_size) {
+    const uint16_t literal = cdcl->trail[cdcl->propagated++];
+    uint32_t conflict = NO_CONFLICT;
+
+    if (!(literal & 1))
+      conflict = exclude(cdcl, literal >> 1);
+    if (conflict == NO_CONFLICT)
+      conflict = propagate_clauses(cdcl, literal ^ 1);
+    if (conflict != NO_CONFLICT)
+      return conflict;
+  }
+
+  return NO_CONFLICT;
+}
+
+// Conflict analysis
+
+static const uint16_t *conflict_literals(const Cdcl *cdcl,
+                                         const uint32_t conflict,
+                                         uint16_t *buffer, uint16_t *size) {
+  if (conflict & REASON_EXCLUSION) {
+    buffer[0] = negative(conflict >> 16 & 0x7fff);
+    buffer[1] = negative(conflict & 0xffff);
+    *size = 2;
+    return buffer;
+  }
+
+  *size = cdcl->clause_size[conflict];
+  return cdcl->pool + cdcl->clause_start[conflict];
+}
+
+// The clause that implied variable, including the implied literal.
+static const uint16_t *reason_literals(const Cdcl *cdcl,
+                                       const uint16_t variable,
+                                       uint16_t *buffer, uint16_t *size) {
+  const uint32_t reason = cdcl->reason[variable];
+  if (reason & REASON_EXCLUSION) {
+    buffer[0] = negative(reason & 0xffff);
+    buffer[1] = negative(variable);
+    *size = 2;
+    return buffer;
+  }
+
+  *size = cdcl->clause_size[reason];
+  return cdcl->pool + cdcl->clause_start[reason];
+}
+
+static void bump(Cdcl *cdcl, const uint16_t variable) {
+  cdcl->activity[variable] += cdcl->activity_increment;
+  if (cdcl->activity[variable] < ACTIVITY_LIMIT)
+    return;
+
+  for (uint16_t i = 0; i < CDCL_VARIABLES; ++i) {
+    cdcl->activity[i] /= ACTIVITY_LIMIT;
+  }
+  cdcl->activity_increment /= ACTIVITY_LIMIT;
+}
+
+// Learns a first-UIP clause from conflict into learned, asserting literal
+// first and a literal of the backjump level second. Returns the backjump
+// level.
+static uint16_t analyze(Cdcl *cdcl, const uint32_t conflict, uint16_t *size,
+                        uint8_t *lbd) {
+  uint16_t buffer[2];
+  uint16_t count = 0;
+  const uint16_t *literals = conflict_literals(cdcl, conflict, buffer, &count);
+
+  uint16_t learned = 1;
+  uint16_t pending = 0; // current level literals not resolved yet
+  uint16_t index = cdcl->trail_size;
+  uint16_t pivot = NO_VARIABLE;
+
+  while (true) {
+    for (uint16_t i = 0; i < count; ++i) {
+      const uint16_t variable = literals[i] >> 1;
+      if (variable == pivot || cdcl->seen[variable] ||
+          cdcl->level[variable] == 0)
+        continue;
+
+      cdcl->seen[variable] = 1;
+      bump(cdcl, variable);
+      if (cdcl->level[variable] == cdcl->decision_level)
+        pending++;
+      else
+        cdcl->learned[learned++] = literals[i];
+    }
+
+    do {
+      pivot = cdcl->trail[--index] >> 1;
+    } while (!cdcl->seen[pivot]);
+
+    cdcl->seen[pivot] = 0;
+    if (--pending == 0)
+      break;
+
+    literals = reason_literals(cdcl, pivot, buffer, &count);
+  }
+
+  cdcl->learned[0] = cdcl->trail[index] ^ 1;
+
+  // Clear the marks, count the levels and find the backjump level
+  uint16_t backjump = 0;
+  uint16_t second = 1;
+  uint8_t levels = 0;
+  cdcl->stamp++;
+  for (uint16_t i = 0; i < learned; ++i) {
+    const uint16_t variable = cdcl->learned[i] >> 1;
+    const uint16_t level = cdcl->level[variable];
+    cdcl->seen[variable] = 0;
+
+    if (cdcl->level_stamp[level] != cdcl->stamp) {
+      cdcl->level_stamp[level] = cdcl->stamp;
+      levels += levels < UINT8_MAX;
+    }
+
+    if (i > 0 && level > backjump) {
+      backjump = level;
+      second = i;
+    }
+  }
+
+  const uint16_t literal = cdcl->learned[1];
+  cdcl->learned[1] = cdcl->learned[second];
+  cdcl->learned[second] = literal;
+
+  *size = learned;
+  *lbd = levels;
+  return backjump;
+}
+
+// Adds the clause left in learned by analyze().
+static bool learn(Cdcl *cdcl, const uint16_t backjump, const uint16_t size,
+                  const uint8_t lbd) {
+  if (size == 1) {
+    backtrack(cdcl, 0);
+    assign(cdcl, cdcl->learned[0], REASON_DECISION);
+    return true;
+  }
+
+  if (has_room(cdcl, size)) {
+    backtrack(cdcl, backjump);
+    assign(cdcl, cdcl->learned[0],
+           add_clause(cdcl, cdcl->learned, size, lbd));
+    return true;
+  }
+
+  // None of the literals is decided at level 0, so after restarting they are
+  // all unassigned and the clause implies nothing yet
+  backtrack(cdcl, 0);
+  reduce(cdcl);
+  if (!has_room(cdcl, size))
+    return false;
+
+  add_clause(cdcl, cdcl->learned, size, lbd);
+  return true;
+}
+
+// Search
+
+// Element x of the Luby sequence 1, 1, 2, 1, 1, 2, 4, ...
+static uint32_t luby(uint32_t x) {
+  uint32_t size = 1;
+  uint32_t sequence = 0;
+  while (size < x + 1) {
+    sequence++;
+    size = size * 2 + 1;
+  }
+
+  while (size - 1 != x) {
+    size = (size - 1) >> 1;
+    sequence--;
+    x %= size;
+  }
+
+  return 1u << sequence;
+}
+
+static bool decide(Cdcl *cdcl) {
+  uint16_t best = NO_VARIABLE;
+  for (uint16_t i = 0; i < CDCL_VARIABLES; ++i) {
+    if (cdcl->assignment[i] == CDCL_UNASSIGNED &&
+        (best == NO_VARIABLE || cdcl->activity[i] > cdcl->activity[best]))
+      best = i;
+  }
+
+  if (best == NO_VARIABLE)
+    return false;
+
+  cdcl->level_start[++cdcl->decision_level] = cdcl->trail_size;
+  assign(cdcl,
+         cdcl->phase[best] == CDCL_TRUE ? positive(best) : negative(best),
+         REASON_DECISION);
+  return true;
+}
+
+void cdcl_init(Cdcl *cdcl, const uint8_t *values) {
+  cdcl->pool_size = 0;
+  cdcl->clause_count = 0;
+  for (uint16_t i = 0; i < CDCL_LITERALS; ++i) {
+    cdcl->watch_head[i] = NO_WATCH;
+  }
+
+  for (uint16_t i = 0; i < CDCL_VARIABLES; ++i) {
+    cdcl->assignment[i] = CDCL_UNASSIGNED;
+    cdcl->phase[i] = CDCL_TRUE;
+    cdcl->seen[i] = 0;
+    cdcl->activity[i] = 0;
+  }
+  for (uint16_t i = 0; i <= CDCL_VARIABLES; ++i) {
+    cdcl->level_stamp[i] = 0;
+  }
+
+  cdcl->activity_increment = 1;
+  cdcl->trail_size = 0;
+  cdcl->propagated = 0;
+  cdcl->decision_level = 0;
+  cdcl->stamp = 0;
+  cdcl->conflicts = 0;
+  cdcl->restarts = 0;
+  cdcl->restart_limit = CDCL_RESTART_BASE;
+  cdcl->unsat = false;
+
+  // Every cell has a digit
+  uint16_t literals[BOARD_SIDE_LENGTH];
+  for (uint8_t cell = 0; cell < BOARD_SIZE; ++cell) {
+    for (uint8_t digit = 0; digit < CELL_VALUE_MAX; ++digit) {
+      literals[digit] = positive(cell * CELL_VALUE_MAX + digit);
+    }
+    add_clause(cdcl, literals, CELL_VALUE_MAX, 0);
+  }
+
+  // Every unit has every digit
+  for (uint8_t unit = 0; unit < UNIT_COUNT; ++unit) {
+    const uint8_t *cells = get_unit_cells(unit);
+    for (uint8_t digit = 0; digit < CELL_VALUE_MAX; ++digit) {
+      for (uint8_t i = 0; i < BOARD_SIDE_LENGTH; ++i) {
+        literals[i] = positive(cells[i] * CELL_VALUE_MAX + digit);
+      }
+      add_clause(cdcl, literals, BOARD_SIDE_LENGTH, 0);
+    }
+  }
+
+  // Givens repeating a digit conflict on the first propagation
+  for (uint8_t cell = 0; cell < BOARD_SIZE; ++cell) {
+    if (values[cell] != CELL_VALUE_EMPTY)
+      assign(cdcl, positive(cell * CELL_VALUE_MAX + values[cell] - 1),
+             REASON_DECISION);
+  }
+}
+
+CdclResult cdcl_solve(Cdcl *cdcl) {
+  while (!cdcl->unsat) {
+    const uint32_t conflict = propagate(cdcl);
+
+    if (conflict == NO_CONFLICT) {
+      if (decide(cdcl))
+        continue;
+
+      for (uint16_t i = 0; i < CDCL_VARIABLES; ++i) {
+        if (cdcl->assignment[i] == CDCL_TRUE)
+          cdcl->values[i / CELL_VALUE_MAX] = i % CELL_VALUE_MAX + 1;
+      }
+      return CDCL_SAT;
+    }
+
+    if (cdcl->decision_level == 0) {
+      cdcl->unsat = true;
+      break;
+    }
+
+    uint16_t size = 0;
+    uint8_t lbd = 0;
+    const uint16_t backjump = analyze(cdcl, conflict, &size, &lbd);
+    if (!learn(cdcl, backjump, size, lbd))
+      return CDCL_FULL;
+
+    cdcl->activity_increment /= ACTIVITY_DECAY;
+    if (++cdcl->conflicts >= cdcl->restart_limit) {
+      backtrack(cdcl, 0);
+      cdcl->restart_limit =
+          cdcl->conflicts + luby(++cdcl->restarts) * CDCL_RESTART_BASE;
+    }
+  }
+
+  return CDCL_UNSAT;
+}
+
+bool cdcl_block(Cdcl *cdcl) {
+  // The decisions imply the whole solution, so any other solution breaks one
+  const uint16_t size = cdcl->decision_level;
+  for (uint16_t level = 1; level <= size; ++level) {
+    cdcl->learned[level - 1] = cdcl->trail[cdcl->level_start[level]] ^ 1;
+  }
+
+  backtrack(cdcl, 0);
+  if (size == 0) {
+    // The givens decide every cell
+    cdcl->unsat = true;
+  } else if (size == 1) {
+    assign(cdcl, cdcl->learned[0], REASON_DECISION);
+  } else {
+    if (!has_blocking_room(cdcl, size))
+      return false;
+    if (!has_room(cdcl, size))
+      reduce(cdcl);
+    if (!has_room(cdcl, size))
+      return false;
+    add_clause(cdcl, cdcl->learned, size, 0);
+  }
+
+  return true;
+}
+
+static Cdcl *allocate_solver(Arena *arena) {
+  Cdcl *cdcl = arena_alloc(arena, sizeof(Cdcl));
+  if (!cdcl) {
+    ERROR("Not enough scratch memory for the CDCL solver");
+  }
+
+  return cdcl;
+}
+
+CdclResult cdcl_solve_values(const uint8_t *values, uint8_t *solution) {
+  Arena *arena = get_scratch_arena();
+  const size_t mark = arena_mark(arena);
+
+  Cdcl *cdcl = allocate_solver(arena);
+  if (!cdcl)
+    return CDCL_FULL;
+
+  cdcl_init(cdcl, values);
+  const CdclResult result = cdcl_solve(cdcl);
+  if (result == CDCL_SAT)
+    memcpy(solution, cdcl->values, BOARD_SIZE);
+
+  arena_rewind(arena, mark);
+  return result;
+}
+
+bool cdcl_count(const uint8_t *values, const uint64_t limit, uint64_t *count) {
+  Arena *arena = get_scratch_arena();
+  const size_t mark = arena_mark(arena);
+  *count = 0;
+
+  Cdcl *cdcl = allocate_solver(arena);
+  if (!cdcl)
+    return false;
+
+  cdcl_init(cdcl, values);
+  CdclResult result = CDCL_UNSAT;
+  while (limit == 0 || *count < limit) {
+    result = cdcl_solve(cdcl);
+    if (result != CDCL_SAT)
+      break;
+
+    ++*count;
+    if (*count != limit && !cdcl_block(cdcl)) {
+      result = CDCL_FULL;
+      break;
+    }
+  }
+
+  arena_rewind(arena, mark);
+  return result != CDCL_FULL;
+}
@@ -0,0 +1,231 @@
+#include "corpus.h"
+#include "memory.h"
+#include "search.h"
+#include "units.h"
+#include "walloc.h"
+
+static Corpus corpus;
+static Importer importer;
+static uint8_t import_buffer[IMPORT_BUFFER_SIZE];
+
+// What a byte means to the parser. Cells are CHAR_CELL + their value, so
+// unlisted bytes fall to CHAR_OTHER.
+enum {
+  CHAR_OTHER,
+  CHAR_SPACE,
+  CHAR_NEWLINE,
+  CHAR_COMMENT,
+  CHAR_CELL,
+};
+
+static const uint8_t char_classes[256] = {
+    [' '] = CHAR_SPACE,
+    ['\t'] = CHAR_SPACE,
+    ['\r'] = CHAR_SPACE,
+    ['\n'] = CHAR_NEWLINE,
+    ['#'] = CHAR_COMMENT,
+    ['['] = CHAR_COMMENT,
+    ['.'] = CHAR_CELL + CELL_VALUE_EMPTY,
+    ['0'] = CHAR_CELL + CELL_VALUE_EMPTY,
+    ['1'] = CHAR_CELL + 1,
+    ['2'] = CHAR_CELL + 2,
+    ['3'] = CHAR_CELL + 3,
+    ['4'] = CHAR_CELL + 4,
+    ['5'] = CHAR_CELL + 5,
+    ['6'] = CHAR_CELL + 6,
+    ['7'] = CHAR_CELL + 7,
+    ['8'] = CHAR_CELL + 8,
+    ['9'] = CHAR_CELL + 9,
+};
+
+static bool is_consistent(const uint8_t *values) {
+  uint16_t seen[UNIT_COUNT] = {0};
+
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    if (values[i] == CELL_VALUE_EMPTY)
+      continue;
+
+    const uint16_t mask = DIGIT_MASK(values[i]);
+    const uint8_t *units = get_cell_units(i);
+    for (uint8_t u = 0; u < UNITS_PER_CELL; ++u) {
+      if (seen[units[u]] & mask)
+        return false;
+      seen[units[u]] |= mask;
+    }
+  }
+
+  return true;
+}
+
+static bool grow_corpus(void) {
+  if (corpus.capacity > UINT32_MAX / 2)
+    return false;
+
+  const uint32_t capacity =
+      corpus.capacity ? corpus.capacity * 2 : CORPUS_INITIAL_CAPACITY;
+  if (capacity > SIZE_MAX / CORPUS_PUZZLE_SIZE)
+    return false;
+
+  uint8_t *puzzles = malloc((size_t)capacity * CORPUS_PUZZLE_SIZE);
+  if (!puzzles)
+    return false;
+
+  if (corpus.puzzles) {
+    memcpy(puzzles, corpus.puzzles, (size_t)corpus.count * CORPUS_PUZZLE_SIZE);
+    free(corpus.puzzles);
+  }
+  corpus.puzzles = puzzles;
+  corpus.capacity = capacity;
+  return true;
+}
+
+// Moves the completed puzzle in importer.cells to the corpus.
+static bool add_puzzle(void) {
+  importer.filled = 0;
+
+  if (!is_consistent(importer.cells)) {
+    importer.malformed++;
+    return true;
+  }
+
+  if (corpus.count == corpus.capacity && !grow_corpus())
+    return false;
+
+  uint8_t *out = corpus.puzzles + (size_t)corpus.count++ * CORPUS_PUZZLE_SIZE;
+  for (uint8_t i = 0; i < BOARD_SIZE; i += 2) {
+    const uint8_t high = i + 1 < BOARD_SIZE ? importer.cells[i + 1] : 0;
+    out[i / 2] = importer.cells[i] | high << 4;
+  }
+
+  return true;
+}
+
+static bool end_line(void) {
+  const uint8_t cells = importer.line_cells;
+  const uint8_t state = importer.line_state;
+  importer.line_cells = 0;
+  importer.line_state = IMPORT_LINE_CELLS;
+
+  if (state == IMPORT_LINE_COMMENT)
+    return true;
+
+  if (state != IMPORT_LINE_BAD) {
+    // Blank lines separate puzzles
+    if (cells == 0 && importer.filled == 0)
+      return true;
+
+    // A whole line always starts at filled == 0, see import_chunk()
+    if (cells == BOARD_SIZE)
+      return add_puzzle();
+
+    if (cells == BOARD_SIDE_LENGTH) {
+      importer.filled += cells;
+      return importer.filled < BOARD_SIZE || add_puzzle();
+    }
+  }
+
+  importer.malformed++;
+  importer.filled = 0;
+  return true;
+}
+
+uint8_t *get_import_buffer(void) { return import_buffer; }
+
+bool import_chunk(const uint8_t *data, const size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    const uint8_t kind = char_classes[data[i]];
+
+    if (kind == CHAR_NEWLINE) {
+      if (!end_line())
+        return false;
+      continue;
+    }
+
+    if (importer.line_state != IMPORT_LINE_CELLS)
+      continue;
+
+    if (kind >= CHAR_CELL) {
+      // A row too long for a grid starts a one-line puzzle, which drops the
+      // unfinished grid before it
+      if (importer.filled && importer.line_cells == BOARD_SIDE_LENGTH) {
+        memmove(importer.cells, importer.cells + importer.filled,
+                BOARD_SIDE_LENGTH);
+        importer.filled = 0;
+        importer.malformed++;
+      }
+
+      const uint8_t position = importer.filled + importer.line_cells;
+      if (position >= BOARD_SIZE) {
+        importer.line_state = IMPORT_LINE_BAD;
+      } else {
+        importer.cells[position] = kind - CHAR_CELL;
+        importer.line_cells++;
+      }
+    } else if (kind == CHAR_SPACE) {
+      // Leading whitespace is skipped, anything after the cells is ignored
+      if (importer.line_cells)
+        importer.line_state = IMPORT_LINE_TRAILER;
+    } else if (kind == CHAR_COMMENT && importer.line_cells == 0) {
+      importer.line_state = IMPORT_LINE_COMMENT;
+    } else {
+      importer.line_state = IMPORT_LINE_BAD;
+    }
+  }
+
+  return true;
+}
+
+bool import_finish(void) {
+  bool added = true;
+  if (importer.line_cells || importer.line_state != IMPORT_LINE_CELLS)
+    added = end_line();
+
+  if (importer.filled) {
+    importer.malformed++;
+    importer.filled = 0;
+  }
+
+  return added;
+}
+
+uint32_t get_import_malformed(void) { return importer.malformed; }
+
+uint32_t get_corpus_size(void) { return corpus.count; }
+
+bool get_corpus_puzzle(const uint32_t index, uint8_t *out) {
+  if (index >= corpus.count)
+    return false;
+
+  const uint8_t *puzzle = corpus.puzzles + (size_t)index * CORPUS_PUZZLE_SIZE;
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    out[i] = puzzle[i / 2] >> (i % 2 * 4) & 0x0f;
+  }
+
+  return true;
+}
+
+void clear_corpus(void) {
+  free(corpus.puzzles);
+  corpus = (Corpus){0};
+  importer = (Importer){0};
+}
+
+bool sudoku_load_corpus_puzzle(SudokuContext *ctx, const uint32_t index) {
+  uint8_t givens[BOARD_SIZE];
+  if (!get_corpus_puzzle(index, givens))
+    return false;
+
+  Search search;
+  search_init(&search, givens);
+  if (search_next(&search, SEARCH_UNBOUNDED) != SEARCH_SOLUTION)
+    return false;
+
+  sudoku_load_board(ctx, givens, search.values);
+  return true;
+}
+
+// Default context
+
+bool load_corpus_puzzle(const uint32_t index) {
+  return sudoku_load_corpus_puzzle(get_default_context(), index);
+}
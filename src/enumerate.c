@@ -0,0 +1,88 @@
+#include "enumerate.h"
+#include "cdcl.h"
+#include "context.h"
+#include "memory.h"
+#include "search.h"
+
+static void snapshot_board(const SudokuContext *ctx, uint8_t *values) {
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    values[i] = ctx->board[i].num;
+  }
+}
+
+static bool limit_reached(const uint64_t count, const uint64_t limit) {
+  return limit != 0 && count >= limit;
+}
+
+bool sudoku_enumerate_begin(SudokuContext *ctx, const uint64_t limit) {
+  uint8_t values[BOARD_SIZE];
+  snapshot_board(ctx, values);
+
+  ctx->enumeration.limit = limit;
+  ctx->enumeration.count = 0;
+  return search_init(&ctx->enumeration.search, values);
+}
+
+uint32_t sudoku_enumerate_next(SudokuContext *ctx, uint8_t *out,
+                               const uint32_t capacity) {
+  Enumeration *enumeration = &ctx->enumeration;
+  uint32_t written = 0;
+
+  while (written < capacity && !sudoku_is_enumeration_done(ctx)) {
+    if (search_next(&enumeration->search, SEARCH_UNBOUNDED) != SEARCH_SOLUTION)
+      break;
+
+    if (out)
+      memcpy(out + written * BOARD_SIZE, enumeration->search.values,
+             BOARD_SIZE);
+    written++;
+    enumeration->count++;
+  }
+
+  return written;
+}
+
+uint64_t sudoku_get_enumerated_count(const SudokuContext *ctx) {
+  return ctx->enumeration.count;
+}
+
+bool sudoku_is_enumeration_done(const SudokuContext *ctx) {
+  const Enumeration *enumeration = &ctx->enumeration;
+  return enumeration->search.exhausted ||
+         limit_reached(enumeration->count, enumeration->limit);
+}
+
+uint64_t sudoku_count_all_solutions(const SudokuContext *ctx,
+                                    const uint64_t limit) {
+  uint8_t values[BOARD_SIZE];
+  snapshot_board(ctx, values);
+
+  // Each solution found costs CDCL a clause, so past a few dozen of them the
+  // backtracker takes over
+  uint64_t count = 0;
+  if (ctx->solver_backend == SOLVER_CDCL && cdcl_count(values, limit, &count))
+    return count;
+
+  return search_count(values, limit);
+}
+
+// Default context
+bool enumerate_begin(const uint64_t limit) {
+  return sudoku_enumerate_begin(get_default_context(), limit);
+}
+
+uint32_t enumerate_next(uint8_t *out, const uint32_t capacity) {
+  return sudoku_enumerate_next(get_default_context(), out, capacity);
+}
+
+uint64_t get_enumerated_count(void) {
+  return sudoku_get_enumerated_count(get_default_context());
+}
+
+bool is_enumeration_done(void) {
+  return sudoku_is_enumeration_done(get_default_context());
+}
+
+uint64_t count_all_solutions(const uint64_t limit) {
+  return sudoku_count_all_solutions(get_default_context(), limit);
+}
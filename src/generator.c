@@ -0,0 +1,421 @@
+#include "generator.h"
+#include "context.h"
+#include "grid.h"
+#include "memory.h"
+#include "search.h"
+#include "units.h"
+
+static void shuffle_array(Rng *rng, uint8_t *array, const uint8_t n) {
+  for (uint8_t i = n - 1; i > 0; --i) {
+    const uint8_t j = rng_bounded(rng, i + 1);
+    const uint8_t t = array[j];
+    array[j] = array[i];
+    array[i] = t;
+  }
+}
+
+static bool has_cell(const uint32_t *cells, const uint8_t index) {
+  return (cells[index / 32] >> (index % 32)) & 1;
+}
+
+static void add_cell(uint32_t *cells, const uint8_t index) {
+  cells[index / 32] |= 1u << (index % 32);
+}
+
+// Writes the distinct cells the symmetry maps index to, index first, and
+// returns how many there are. Cells on an axis or at the centre map to
+// themselves.
+static uint8_t orbit_cells(const Symmetry symmetry, const uint8_t index,
+                           uint8_t *cells) {
+  const uint8_t last = BOARD_SIDE_LENGTH - 1;
+  const uint8_t x = index % BOARD_SIDE_LENGTH;
+  const uint8_t y = index / BOARD_SIDE_LENGTH;
+  uint8_t images[SYMMETRY_MAX_ORBIT] = {index};
+  uint8_t count = 1;
+
+  switch (symmetry) {
+  case SYMMETRY_ROTATE_180:
+    images[count++] = get_board_index(last - x, last - y);
+    break;
+  case SYMMETRY_ROTATE_90:
+    images[count++] = get_board_index(last - y, x);
+    images[count++] = get_board_index(last - x, last - y);
+    images[count++] = get_board_index(y, last - x);
+    break;
+  case SYMMETRY_MIRROR:
+    images[count++] = get_board_index(last - x, y);
+    break;
+  default:
+    break;
+  }
+
+  uint8_t distinct = 0;
+  for (uint8_t i = 0; i < count; ++i) {
+    bool seen = false;
+    for (uint8_t j = 0; j < distinct; ++j) {
+      seen |= cells[j] == images[i];
+    }
+    if (!seen)
+      cells[distinct++] = images[i];
+  }
+
+  return distinct;
+}
+
+static inline uint16_t free_digits(const uint16_t *placed,
+                                   const uint8_t index) {
+  const uint8_t *units = get_cell_units(index);
+  return ~(placed[units[0]] | placed[units[1]] | placed[units[2]]) &
+         ALL_DIGITS_MASK;
+}
+
+// Fast redundancy test. Fills in naked and hidden singles from the givens
+// until the removed cells are all back or nothing is left to fill. The
+// puzzle had a unique solution before the removal, so when singles alone
+// restore the removed cells it still has one, without a search.
+static bool is_removal_forced(const Generation *generation) {
+  uint8_t values[BOARD_SIZE];
+  uint16_t placed[UNIT_COUNT] = {0};
+  memcpy(values, generation->givens, BOARD_SIZE);
+
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    if (values[i] == CELL_VALUE_EMPTY)
+      continue;
+
+    const uint8_t *units = get_cell_units(i);
+    for (uint8_t u = 0; u < UNITS_PER_CELL; ++u) {
+      placed[units[u]] |= DIGIT_MASK(values[i]);
+    }
+  }
+
+  uint8_t missing = generation->removed_count;
+  bool progress = true;
+  while (missing && progress) {
+    progress = false;
+
+    for (uint8_t unit = 0; unit < UNIT_COUNT; ++unit) {
+      const uint8_t *cells = get_unit_cells(unit);
+      uint16_t once = 0, twice = 0;
+      for (uint8_t k = 0; k < BOARD_SIDE_LENGTH; ++k) {
+        if (values[cells[k]] != CELL_VALUE_EMPTY)
+          continue;
+        const uint16_t free = free_digits(placed, cells[k]);
+        twice |= once & free;
+        once |= free;
+      }
+
+      // Digits with a single place left in the unit
+      const uint16_t hidden = once & ~twice;
+      for (uint8_t k = 0; k < BOARD_SIDE_LENGTH; ++k) {
+        const uint8_t cell = cells[k];
+        if (values[cell] != CELL_VALUE_EMPTY)
+          continue;
+
+        const uint16_t free = free_digits(placed, cell);
+        const uint16_t single = free & hidden ? free & hidden : free;
+        if (!single || single & (single - 1))
+          continue;
+
+        values[cell] = __builtin_ctz(single) + CELL_VALUE_MIN;
+        const uint8_t *units = get_cell_units(cell);
+        for (uint8_t u = 0; u < UNITS_PER_CELL; ++u) {
+          placed[units[u]] |= single;
+        }
+        progress = true;
+      }
+    }
+
+    missing = 0;
+    for (uint8_t k = 0; k < generation->removed_count; ++k) {
+      missing += values[generation->removed[k]] == CELL_VALUE_EMPTY;
+    }
+  }
+
+  return missing == 0;
+}
+
+static void restore_removed(Generation *generation) {
+  for (uint8_t k = 0; k < generation->removed_count; ++k) {
+    const uint8_t cell = generation->removed[k];
+    generation->givens[cell] = generation->solution[cell];
+  }
+}
+
+// Clues left when the removal pass is over, counted from the target. Without
+// a target any count will do.
+static uint8_t distance_to_target(const Generation *generation,
+                                  const uint8_t clues) {
+  const uint8_t target = generation->options.clues;
+  if (!target)
+    return 0;
+  return clues > target ? clues - target : target - clues;
+}
+
+// Drops the puzzle and perturbs the best one found on this grid, or starts
+// over from a new grid once this one had GENERATOR_PASSES_PER_GRID passes
+static void retry(Generation *generation) {
+  if (++generation->attempts >= GENERATOR_MAX_ATTEMPTS) {
+    generation->status = TASK_FAILED;
+    return;
+  }
+
+  if (++generation->passes < GENERATOR_PASSES_PER_GRID) {
+    generation->perturb = true;
+    return;
+  }
+
+  generation->has_grid = false;
+  grid_search_init(&generation->search, generation->rng);
+}
+
+// Empties the cells of the next check. Returns false when none is left.
+static bool begin_removal_of_next(Generation *generation) {
+  if (generation->minimizing) {
+    while (generation->next < BOARD_SIZE &&
+           (generation->givens[generation->next] == CELL_VALUE_EMPTY ||
+            has_cell(generation->needed, generation->next))) {
+      generation->next++;
+    }
+    if (generation->next >= BOARD_SIZE)
+      return false;
+
+    generation->removed[0] = generation->next;
+    generation->removed_count = 1;
+  } else {
+    while (true) {
+      if (generation->next >= generation->orbit_count ||
+          generation->clues <= MINIMUM_CLUES)
+        return false;
+
+      // Orbits emptied by an earlier pass stay empty
+      const uint8_t first = generation->order[generation->next];
+      if (generation->givens[first] != CELL_VALUE_EMPTY) {
+        generation->removed_count = orbit_cells(generation->options.symmetry,
+                                                first, generation->removed);
+        if (generation->clues - generation->removed_count >= MINIMUM_CLUES)
+          break;
+      }
+      generation->next++;
+    }
+  }
+
+  for (uint8_t k = 0; k < generation->removed_count; ++k) {
+    generation->givens[generation->removed[k]] = CELL_VALUE_EMPTY;
+  }
+  return true;
+}
+
+// Applies the result of a check. Returns false when the puzzle was dropped.
+static bool end_check(Generation *generation, const bool unique) {
+  if (generation->minimizing) {
+    // A clue that can go is redundant, so the puzzle is not minimal
+    if (unique) {
+      retry(generation);
+      return false;
+    }
+
+    restore_removed(generation);
+  } else if (unique) {
+    generation->clues -= generation->removed_count;
+  } else {
+    restore_removed(generation);
+
+    // Removing fewer clues later cannot make a single one redundant
+    if (generation->removed_count == 1)
+      add_cell(generation->needed, generation->removed[0]);
+  }
+
+  generation->next++;
+  return true;
+}
+
+static void end_pass(Generation *generation);
+
+// Removes the next clues and starts checking that the puzzle stays unique, or
+// ends the pass when no clue is left to try.
+static void begin_uniqueness_check(Generation *generation) {
+  while (begin_removal_of_next(generation)) {
+    if (!is_removal_forced(generation)) {
+      search_init(&generation->search, generation->givens);
+      return;
+    }
+
+    if (!end_check(generation, true))
+      return;
+  }
+
+  end_pass(generation);
+}
+
+static void end_uniqueness_check(Generation *generation, const bool unique) {
+  if (end_check(generation, unique))
+    begin_uniqueness_check(generation);
+}
+
+static void begin_pass(Generation *generation) {
+  for (uint8_t i = 0; i < CELL_BITSET_WORDS; ++i) {
+    generation->needed[i] = 0;
+  }
+
+  generation->minimizing = false;
+  generation->next = 0;
+  begin_uniqueness_check(generation);
+}
+
+// The pass keeps the puzzle if it is no further from the target than the best
+// one so far. Removing whole orbits can leave single clues that are redundant,
+// so at the target every clue not already known to be needed is then tried on
+// its own. Without symmetry every clue has been tried already.
+static void end_pass(Generation *generation) {
+  if (generation->minimizing) {
+    generation->status = TASK_DONE;
+    return;
+  }
+
+  const uint8_t distance = distance_to_target(generation, generation->clues);
+  if (generation->passes &&
+      distance > distance_to_target(generation, generation->best_clues)) {
+    retry(generation);
+    return;
+  }
+
+  memcpy(generation->best, generation->givens, BOARD_SIZE);
+  generation->best_clues = generation->clues;
+  if (distance) {
+    retry(generation);
+    return;
+  }
+
+  generation->minimizing = true;
+  generation->next = 0;
+  begin_uniqueness_check(generation);
+}
+
+// Puts GENERATOR_PERTURBATION removed orbits of the best puzzle back, and
+// removes clues again in a new order that tries them last
+static void perturb(Generation *generation) {
+  memcpy(generation->givens, generation->best, BOARD_SIZE);
+  generation->clues = generation->best_clues;
+  shuffle_array(generation->rng, generation->order, generation->orbit_count);
+
+  uint8_t end = generation->orbit_count;
+  uint8_t restored = 0;
+  for (uint8_t p = end; p-- > 0 && restored < GENERATOR_PERTURBATION;) {
+    const uint8_t first = generation->order[p];
+    if (generation->givens[first] != CELL_VALUE_EMPTY)
+      continue;
+
+    generation->removed_count = orbit_cells(generation->options.symmetry,
+                                            first, generation->removed);
+    restore_removed(generation);
+    generation->clues += generation->removed_count;
+
+    generation->order[p] = generation->order[--end];
+    generation->order[end] = first;
+    restored++;
+  }
+
+  begin_pass(generation);
+}
+
+static void begin_removal(Generation *generation) {
+  memcpy(generation->solution, generation->search.values, BOARD_SIZE);
+  memcpy(generation->givens, generation->solution, BOARD_SIZE);
+
+  uint32_t seen[CELL_BITSET_WORDS] = {0};
+  generation->orbit_count = 0;
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    if (has_cell(seen, i))
+      continue;
+
+    uint8_t cells[SYMMETRY_MAX_ORBIT];
+    const uint8_t count = orbit_cells(generation->options.symmetry, i, cells);
+    for (uint8_t k = 0; k < count; ++k) {
+      add_cell(seen, cells[k]);
+    }
+    generation->order[generation->orbit_count++] = i;
+  }
+  shuffle_array(generation->rng, generation->order, generation->orbit_count);
+
+  generation->has_grid = true;
+  generation->passes = 0;
+  generation->clues = BOARD_SIZE;
+  begin_pass(generation);
+}
+
+void generation_begin(Generation *generation, Rng *rng,
+                      const GeneratorOptions *options) {
+  generation->rng = rng;
+  generation->options = *options;
+  generation->attempts = 0;
+  generation->has_grid = false;
+  generation->perturb = false;
+  generation->status = TASK_RUNNING;
+  grid_search_init(&generation->search, rng);
+
+  if (options->clues > BOARD_SIZE)
+    generation->options.clues = BOARD_SIZE;
+
+  // No puzzle with fewer clues has a unique solution, and quarter turns only
+  // remove four cells at a time, or the centre
+  const uint8_t clues = generation->options.clues;
+  if (clues && (clues < MINIMUM_CLUES ||
+                (options->symmetry == SYMMETRY_ROTATE_90 && clues % 4 > 1)))
+    generation->status = TASK_FAILED;
+}
+
+TaskStatus generation_step(Generation *generation, const uint64_t max_nodes) {
+  uint64_t used = 0;
+
+  while (generation->status == TASK_RUNNING && used < max_nodes) {
+    if (generation->perturb) {
+      generation->perturb = false;
+      perturb(generation);
+      continue;
+    }
+
+    Search *search = &generation->search;
+    const uint64_t nodes = search->nodes;
+    const SearchResult result =
+        generation->has_grid ? search_count_next(search, max_nodes - used)
+                             : search_next(search, max_nodes - used);
+    used += search->nodes - nodes;
+
+    if (result == SEARCH_PAUSED)
+      break;
+
+    if (generation->has_grid) {
+      end_uniqueness_check(generation, search->solutions == 1);
+    } else if (result == SEARCH_SOLUTION) {
+      begin_removal(generation);
+    } else {
+      generation->status = TASK_FAILED;
+    }
+  }
+
+  return generation->status;
+}
+
+bool generate_puzzle(Rng *rng, const GeneratorOptions *options,
+                     uint8_t *givens, uint8_t *solution) {
+  Generation generation;
+  generation_begin(&generation, rng, options);
+
+  if (generation_step(&generation, SEARCH_UNBOUNDED) != TASK_DONE)
+    return false;
+
+  memcpy(givens, generation.givens, BOARD_SIZE);
+  memcpy(solution, generation.solution, BOARD_SIZE);
+  return true;
+}
+
+void sudoku_set_generator_options(SudokuContext *ctx, const Symmetry symmetry,
+                                  const uint8_t clues) {
+  ctx->generator_options = (GeneratorOptions){symmetry, clues};
+}
+
+// Default context
+
+void set_generator_options(const Symmetry symmetry, const uint8_t clues) {
+  sudoku_set_generator_options(get_default_context(), symmetry, clues);
+}
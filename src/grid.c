@@ -0,0 +1,47 @@
+#include "grid.h"
+#include "memory.h"
+#include "search.h"
+#include "units.h"
+
+// The boxes on the diagonal share no unit, so each one can be filled with an
+// independent shuffle before searching the rest.
+static void fill_diagonal_boxes(Rng *rng, uint8_t *values) {
+  for (uint8_t box = 0; box < BOARD_SIDE_LENGTH; box += BOX_SIZE + 1) {
+    const uint8_t *cells = get_unit_cells(BOX_UNIT(box));
+    for (uint8_t i = 0; i < BOARD_SIDE_LENGTH; ++i) {
+      const uint8_t j = rng_bounded(rng, i + 1);
+      values[cells[i]] = values[cells[j]];
+      values[cells[j]] = i + CELL_VALUE_MIN;
+    }
+  }
+}
+
+void grid_search_init(Search *search, Rng *rng) {
+  uint8_t givens[BOARD_SIZE] = {CELL_VALUE_EMPTY};
+  fill_diagonal_boxes(rng, givens);
+
+  search_init(search, givens);
+  search->rng = rng;
+}
+
+bool generate_grid(Rng *rng, uint8_t *values) {
+  Search search;
+  grid_search_init(&search, rng);
+
+  if (search_next(&search, SEARCH_UNBOUNDED) != SEARCH_SOLUTION)
+    return false;
+
+  memcpy(values, search.values, BOARD_SIZE);
+  return true;
+}
+
+uint32_t generate_grids(uint8_t *out, const uint32_t count) {
+  uint32_t written = 0;
+
+  while (written < count &&
+         generate_grid(get_rng(), out + written * BOARD_SIZE)) {
+    written++;
+  }
+
+  return written;
+}
@@ -0,0 +1,424 @@
+#include "hints.h"
+#include "context.h"
+#include "sudoku.h"
+#include "units.h"
+
+#define SUBSET_MAX_SIZE 4
+
+// Record being built, only set while sudoku_find_next_step() runs
+static Hint *hint = NULL;
+static uint16_t cand[BOARD_SIZE];
+
+static inline uint8_t popcount(const uint16_t mask) {
+  return __builtin_popcount(mask);
+}
+
+static inline uint8_t lowest_digit(const uint16_t mask) {
+  return __builtin_ctz(mask) + CELL_VALUE_MIN;
+}
+
+static bool cells_see(const uint8_t a, const uint8_t b) {
+  if (a == b)
+    return false;
+
+  const uint8_t *units_a = get_cell_units(a);
+  const uint8_t *units_b = get_cell_units(b);
+  for (uint8_t u = 0; u < UNITS_PER_CELL; ++u) {
+    if (units_a[u] == units_b[u])
+      return true;
+  }
+
+  return false;
+}
+
+static bool cell_in_unit(const uint8_t cell, const uint8_t unit) {
+  const uint8_t *units = get_cell_units(cell);
+  return units[0] == unit || units[1] == unit || units[2] == unit;
+}
+
+// Bit j is set when the j-th cell of the unit can hold one of the digits.
+static uint16_t digit_positions(const uint8_t unit, const uint16_t digits) {
+  const uint8_t *cells = get_unit_cells(unit);
+  uint16_t positions = 0;
+
+  for (uint8_t j = 0; j < BOARD_SIDE_LENGTH; ++j) {
+    if (cand[cells[j]] & digits)
+      positions |= 1u << j;
+  }
+
+  return positions;
+}
+
+// Hint record building
+static void begin_hint(const HintTechnique technique, const uint8_t unit,
+                       const uint8_t value) {
+  hint->technique = technique;
+  hint->unit = unit;
+  hint->value = value;
+  hint->target_count = 0;
+  hint->elimination_count = 0;
+}
+
+static void add_target(const uint8_t cell) {
+  if (hint->target_count < HINT_MAX_TARGETS)
+    hint->targets[hint->target_count++] = cell;
+}
+
+static void add_targets_at(const uint8_t unit, const uint16_t positions) {
+  const uint8_t *cells = get_unit_cells(unit);
+  for (uint8_t j = 0; j < BOARD_SIDE_LENGTH; ++j) {
+    if (positions & (1u << j))
+      add_target(cells[j]);
+  }
+}
+
+static void add_elimination(const uint8_t cell, const uint16_t mask) {
+  const uint16_t removed = cand[cell] & mask;
+  if (!removed || hint->elimination_count >= HINT_MAX_ELIMINATIONS)
+    return;
+
+  hint->elimination_cells[hint->elimination_count] = cell;
+  hint->elimination_masks[hint->elimination_count] = removed;
+  hint->elimination_count++;
+}
+
+// Singles
+static bool find_naked_single(void) {
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    if (cand[i] && popcount(cand[i]) == 1) {
+      begin_hint(HINT_NAKED_SINGLE, HINT_NO_UNIT, lowest_digit(cand[i]));
+      add_target(i);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static bool find_hidden_single(void) {
+  for (uint8_t unit = 0; unit < UNIT_COUNT; ++unit) {
+    for (SudokuValue value = CELL_VALUE_MIN; value <= CELL_VALUE_MAX;
+         ++value) {
+      const uint16_t positions = digit_positions(unit, DIGIT_MASK(value));
+      if (popcount(positions) == 1) {
+        begin_hint(HINT_HIDDEN_SINGLE, unit, value);
+        add_targets_at(unit, positions);
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+// Intersections
+static bool eliminate_outside(const uint8_t unit, const uint8_t keep_unit,
+                              const uint16_t mask) {
+  const uint8_t *cells = get_unit_cells(unit);
+  for (uint8_t j = 0; j < BOARD_SIDE_LENGTH; ++j) {
+    if (!cell_in_unit(cells[j], keep_unit))
+      add_elimination(cells[j], mask);
+  }
+
+  return hint->elimination_count > 0;
+}
+
+static bool find_pointing(void) {
+  for (uint8_t b = 0; b < BOARD_SIDE_LENGTH; ++b) {
+    const uint8_t box = BOX_UNIT(b);
+    const uint8_t *cells = get_unit_cells(box);
+
+    for (SudokuValue value = CELL_VALUE_MIN; value <= CELL_VALUE_MAX;
+         ++value) {
+      const uint16_t positions = digit_positions(box, DIGIT_MASK(value));
+      if (popcount(positions) < 2)
+        continue;
+
+      // Box cells are stored in reading order, BOX_SIZE per box row
+      for (uint8_t k = 0; k < BOX_SIZE; ++k) {
+        const uint16_t row_bits = 0x7u << (k * BOX_SIZE);
+        const uint16_t col_bits = 0x49u << k;
+        const uint8_t *units = get_cell_units(cells[__builtin_ctz(positions)]);
+        uint8_t line;
+
+        if ((positions & ~row_bits) == 0) {
+          line = units[0];
+        } else if ((positions & ~col_bits) == 0) {
+          line = units[1];
+        } else {
+          continue;
+        }
+
+        begin_hint(HINT_POINTING, box, value);
+        add_targets_at(box, positions);
+        if (eliminate_outside(line, box, DIGIT_MASK(value)))
+          return true;
+        break;
+      }
+    }
+  }
+
+  return false;
+}
+
+static bool find_box_line_reduction(void) {
+  for (uint8_t line = 0; line < BOARD_SIDE_LENGTH * 2; ++line) {
+    const uint8_t *cells = get_unit_cells(line);
+
+    for (SudokuValue value = CELL_VALUE_MIN; value <= CELL_VALUE_MAX;
+         ++value) {
+      const uint16_t positions = digit_positions(line, DIGIT_MASK(value));
+      if (popcount(positions) < 2)
+        continue;
+
+      // Every BOX_SIZE consecutive cells of a row or column share a box
+      for (uint8_t k = 0; k < BOX_SIZE; ++k) {
+        if ((positions & ~(0x7u << (k * BOX_SIZE))) != 0)
+          continue;
+
+        const uint8_t box = get_cell_units(cells[k * BOX_SIZE])[2];
+        begin_hint(HINT_BOX_LINE_REDUCTION, line, value);
+        add_targets_at(line, positions);
+        if (eliminate_outside(box, line, DIGIT_MASK(value)))
+          return true;
+        break;
+      }
+    }
+  }
+
+  return false;
+}
+
+// Subsets
+static bool naked_subset_search(const uint8_t unit, const uint8_t *pool,
+                                const uint8_t pool_size, const uint8_t start,
+                                const uint8_t size, uint8_t *chosen,
+                                const uint8_t depth, const uint16_t digits) {
+  if (popcount(digits) > size)
+    return false;
+
+  if (depth == size) {
+    // Fewer digits than cells means the board is already contradictory
+    if (popcount(digits) != size)
+      return false;
+
+    begin_hint(HINT_NAKED_SUBSET, unit, 0);
+    for (uint8_t i = 0; i < size; ++i) {
+      add_target(chosen[i]);
+    }
+
+    const uint8_t *cells = get_unit_cells(unit);
+    for (uint8_t j = 0; j < BOARD_SIDE_LENGTH; ++j) {
+      bool in_subset = false;
+      for (uint8_t i = 0; i < size; ++i) {
+        in_subset |= cells[j] == chosen[i];
+      }
+      if (!in_subset)
+        add_elimination(cells[j], digits);
+    }
+
+    return hint->elimination_count > 0;
+  }
+
+  for (uint8_t i = start; i < pool_size; ++i) {
+    chosen[depth] = pool[i];
+    if (naked_subset_search(unit, pool, pool_size, i + 1, size, chosen,
+                            depth + 1, digits | cand[pool[i]]))
+      return true;
+  }
+
+  return false;
+}
+
+static bool hidden_subset_search(const uint8_t unit, const uint16_t *positions,
+                                 const uint8_t start, const uint8_t size,
+                                 const uint8_t depth, const uint16_t digits,
+                                 const uint16_t cells_mask) {
+  if (popcount(cells_mask) > size)
+    return false;
+
+  if (depth == size) {
+    if (popcount(cells_mask) != size)
+      return false;
+
+    begin_hint(HINT_HIDDEN_SUBSET, unit, 0);
+    add_targets_at(unit, cells_mask);
+
+    const uint8_t *cells = get_unit_cells(unit);
+    for (uint8_t j = 0; j < BOARD_SIDE_LENGTH; ++j) {
+      if (cells_mask & (1u << j))
+        add_elimination(cells[j], ALL_DIGITS_MASK & ~digits);
+    }
+
+    return hint->elimination_count > 0;
+  }
+
+  for (uint8_t digit = start; digit < CELL_VALUE_MAX; ++digit) {
+    const uint8_t count = popcount(positions[digit]);
+    if (count < 2 || count > size)
+      continue;
+
+    if (hidden_subset_search(unit, positions, digit + 1, size, depth + 1,
+                             digits | (1u << digit),
+                             cells_mask | positions[digit]))
+      return true;
+  }
+
+  return false;
+}
+
+static bool find_subsets(void) {
+  for (uint8_t size = 2; size <= SUBSET_MAX_SIZE; ++size) {
+    for (uint8_t unit = 0; unit < UNIT_COUNT; ++unit) {
+      const uint8_t *cells = get_unit_cells(unit);
+      uint8_t pool[BOARD_SIDE_LENGTH];
+      uint8_t pool_size = 0;
+
+      for (uint8_t j = 0; j < BOARD_SIDE_LENGTH; ++j) {
+        const uint8_t count = popcount(cand[cells[j]]);
+        if (count >= 2 && count <= size)
+          pool[pool_size++] = cells[j];
+      }
+
+      uint8_t chosen[SUBSET_MAX_SIZE];
+      if (naked_subset_search(unit, pool, pool_size, 0, size, chosen, 0, 0))
+        return true;
+    }
+
+    for (uint8_t unit = 0; unit < UNIT_COUNT; ++unit) {
+      uint16_t positions[CELL_VALUE_MAX];
+      for (uint8_t digit = 0; digit < CELL_VALUE_MAX; ++digit) {
+        positions[digit] = digit_positions(unit, 1u << digit);
+      }
+
+      if (hidden_subset_search(unit, positions, 0, size, 0, 0, 0))
+        return true;
+    }
+  }
+
+  return false;
+}
+
+// Wings
+static bool find_x_wing(void) {
+  for (SudokuValue value = CELL_VALUE_MIN; value <= CELL_VALUE_MAX; ++value) {
+    const uint16_t mask = DIGIT_MASK(value);
+
+    // Rows as base lines eliminate in columns and vice versa
+    for (uint8_t base = 0; base < 2; ++base) {
+      const uint8_t first = base * BOARD_SIDE_LENGTH;
+      const uint8_t cover = (1 - base) * BOARD_SIDE_LENGTH;
+
+      for (uint8_t a = 0; a < BOARD_SIDE_LENGTH; ++a) {
+        const uint16_t positions = digit_positions(first + a, mask);
+        if (popcount(positions) != 2)
+          continue;
+
+        for (uint8_t b = a + 1; b < BOARD_SIDE_LENGTH; ++b) {
+          if (digit_positions(first + b, mask) != positions)
+            continue;
+
+          begin_hint(HINT_X_WING, first + a, value);
+          add_targets_at(first + a, positions);
+          add_targets_at(first + b, positions);
+
+          for (uint8_t j = 0; j < BOARD_SIDE_LENGTH; ++j) {
+            if (!(positions & (1u << j)))
+              continue;
+
+            const uint8_t *cells = get_unit_cells(cover + j);
+            for (uint8_t k = 0; k < BOARD_SIDE_LENGTH; ++k) {
+              if (!cell_in_unit(cells[k], first + a) &&
+                  !cell_in_unit(cells[k], first + b))
+                add_elimination(cells[k], mask);
+            }
+          }
+
+          if (hint->elimination_count > 0)
+            return true;
+        }
+      }
+    }
+  }
+
+  return false;
+}
+
+static bool find_xy_wing(void) {
+  for (uint8_t pivot = 0; pivot < BOARD_SIZE; ++pivot) {
+    if (popcount(cand[pivot]) != 2)
+      continue;
+
+    const uint8_t *peers = get_cell_peers(pivot);
+    for (uint8_t i = 0; i < PEER_COUNT; ++i) {
+      const uint8_t first = peers[i];
+      const uint16_t shared = cand[first] & cand[pivot];
+      if (popcount(cand[first]) != 2 || popcount(shared) != 1)
+        continue;
+
+      // The pincers share a digit z and each shares one pivot digit
+      const uint16_t z = cand[first] & ~cand[pivot];
+      const uint16_t second_mask = (cand[pivot] & ~shared) | z;
+
+      for (uint8_t k = 0; k < PEER_COUNT; ++k) {
+        const uint8_t second = peers[k];
+        if (second == first || cand[second] != second_mask)
+          continue;
+
+        begin_hint(HINT_XY_WING, HINT_NO_UNIT, lowest_digit(z));
+        add_target(pivot);
+        add_target(first);
+        add_target(second);
+
+        for (uint8_t cell = 0; cell < BOARD_SIZE; ++cell) {
+          if (cell != pivot && cells_see(cell, first) &&
+              cells_see(cell, second))
+            add_elimination(cell, z);
+        }
+
+        if (hint->elimination_count > 0)
+          return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+Hint *sudoku_find_next_step(SudokuContext *ctx) {
+  const uint16_t *candidates = sudoku_get_candidates(ctx);
+  HintState *state = &ctx->hints;
+  uint16_t *eliminated = state->eliminated;
+
+  if (state->eliminated_epoch != sudoku_get_candidate_epoch(ctx)) {
+    state->eliminated_epoch = sudoku_get_candidate_epoch(ctx);
+    for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+      eliminated[i] = 0;
+    }
+  }
+
+  hint = &state->hint;
+
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    cand[i] = candidates[i] & ~eliminated[i];
+  }
+
+  const bool found = find_naked_single() || find_hidden_single() ||
+                     find_pointing() || find_box_line_reduction() ||
+                     find_subsets() || find_x_wing() || find_xy_wing();
+
+  if (!found) {
+    begin_hint(HINT_NONE, HINT_NO_UNIT, 0);
+  }
+
+  for (uint8_t i = 0; i < hint->elimination_count; ++i) {
+    eliminated[hint->elimination_cells[i]] |= hint->elimination_masks[i];
+  }
+
+  hint = NULL;
+  return &state->hint;
+}
+
+Hint *find_next_step(void) {
+  return sudoku_find_next_step(get_default_context());
+}
@@ -0,0 +1,85 @@
+#include "journal.h"
+
+#define JOURNAL_MASK (JOURNAL_CAPACITY - 1)
+
+static inline bool starts_step(const Journal *journal,
+                               const uint32_t position) {
+  return journal->entries[position & JOURNAL_MASK].flags & JOURNAL_STEP_START;
+}
+
+void journal_clear(Journal *journal) {
+  journal->start = 0;
+  journal->cursor = 0;
+  journal->end = 0;
+  journal->group_depth = 0;
+  journal->step_open = false;
+}
+
+void journal_begin_step(Journal *journal) {
+  if (journal->group_depth == 0)
+    journal->step_open = false;
+}
+
+void journal_begin_group(Journal *journal) {
+  if (journal->group_depth++ == 0)
+    journal->step_open = false;
+}
+
+void journal_end_group(Journal *journal) {
+  if (journal->group_depth > 0)
+    journal->group_depth--;
+}
+
+void journal_record(Journal *journal, JournalEntry entry) {
+  journal->end = journal->cursor;
+
+  if (journal->end - journal->start == JOURNAL_CAPACITY) {
+    // Drop the oldest step whole
+    do {
+      journal->start++;
+    } while (journal->start != journal->end &&
+             !starts_step(journal, journal->start));
+  }
+
+  entry.flags = journal->step_open ? 0 : JOURNAL_STEP_START;
+  journal->step_open = true;
+
+  journal->entries[journal->end++ & JOURNAL_MASK] = entry;
+  journal->cursor = journal->end;
+}
+
+bool journal_undo_step(Journal *journal, uint32_t *first, uint32_t *last) {
+  if (journal->cursor == journal->start)
+    return false;
+
+  *last = journal->cursor;
+  do {
+    journal->cursor--;
+  } while (journal->cursor != journal->start &&
+           !starts_step(journal, journal->cursor));
+  *first = journal->cursor;
+
+  // Whatever is recorded next starts its own step
+  journal->step_open = false;
+  return true;
+}
+
+bool journal_redo_step(Journal *journal, uint32_t *first, uint32_t *last) {
+  if (journal->cursor == journal->end)
+    return false;
+
+  *first = journal->cursor;
+  do {
+    journal->cursor++;
+  } while (journal->cursor != journal->end &&
+           !starts_step(journal, journal->cursor));
+  *last = journal->cursor;
+
+  journal->step_open = false;
+  return true;
+}
+
+const JournalEntry *journal_entry(const Journal *journal,
+                                  const uint32_t position) {
+  return &journal->entries[position & JOURNAL_MASK];
+}
@@ -1,9 +1,15 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "rand.h"
-
-uint32_t seed;
+#include "sudoku.h"
 
 void setup(uint32_t new_seed) {
-  seed = new_seed;
+  rng_seed(get_rng(), new_seed, 0);
+  sudoku_seed(get_default_context(), new_seed, 0);
+}
+
+// Seeds the generator for the INDEX-th puzzle of the sequence started by SEED,
+// so that the next fill_random_board() can be reproduced from the pair.
+void seed_puzzle(uint64_t seed, uint32_t index) {
+  sudoku_seed(get_default_context(), seed, index);
 }
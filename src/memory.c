@@ -1,12 +1,109 @@
 #include "memory.h"
+#include <stdint.h>
 
+#ifdef __wasm_bulk_memory__
+
+// memory.copy handles overlapping ranges, so memcpy and memmove are the same
+// instruction.
 void *memcpy(void *destination, const void *source, size_t num) {
-  char *dest = (char *)(destination);
-  const char *src = (const char *)(source);
+  return __builtin_memcpy(destination, source, num);
+}
+
+void *memmove(void *destination, const void *source, size_t num) {
+  return __builtin_memmove(destination, source, num);
+}
+
+void *memset(void *destination, int value, size_t num) {
+  return __builtin_memset(destination, value, num);
+}
+
+#else
+
+typedef uint64_t __attribute__((__may_alias__)) word;
+
+#define WORD_SIZE sizeof(word)
+#define WORD_MASK (WORD_SIZE - 1)
+
+static inline bool can_copy_words(const void *dest, const void *src) {
+  return (((uintptr_t)dest ^ (uintptr_t)src) & WORD_MASK) == 0;
+}
+
+static void copy_forward(unsigned char *dest, const unsigned char *src,
+                         size_t num) {
+  if (can_copy_words(dest, src)) {
+    for (; num && ((uintptr_t)dest & WORD_MASK); --num) {
+      *dest++ = *src++;
+    }
+
+    for (; num >= WORD_SIZE; num -= WORD_SIZE) {
+      *(word *)dest = *(const word *)src;
+      dest += WORD_SIZE;
+      src += WORD_SIZE;
+    }
+  }
+
+  for (; num; --num) {
+    *dest++ = *src++;
+  }
+}
+
+static void copy_backward(unsigned char *dest, const unsigned char *src,
+                          size_t num) {
+  dest += num;
+  src += num;
 
-  for (size_t i = 0; i < num; ++i) {
-    dest[i] = src[i];
+  if (can_copy_words(dest, src)) {
+    for (; num && ((uintptr_t)dest & WORD_MASK); --num) {
+      *--dest = *--src;
+    }
+
+    for (; num >= WORD_SIZE; num -= WORD_SIZE) {
+      dest -= WORD_SIZE;
+      src -= WORD_SIZE;
+      *(word *)dest = *(const word *)src;
+    }
+  }
+
+  for (; num; --num) {
+    *--dest = *--src;
+  }
+}
+
+void *memcpy(void *destination, const void *source, size_t num) {
+  copy_forward(destination, source, num);
+  return destination;
+}
+
+void *memmove(void *destination, const void *source, size_t num) {
+  if ((uintptr_t)destination - (uintptr_t)source >= num) {
+    // The destination does not start inside the source
+    copy_forward(destination, source, num);
+  } else {
+    copy_backward(destination, source, num);
   }
 
   return destination;
 }
+
+void *memset(void *destination, int value, size_t num) {
+  unsigned char *dest = destination;
+  const unsigned char byte = (unsigned char)value;
+
+  for (; num && ((uintptr_t)dest & WORD_MASK); --num) {
+    *dest++ = byte;
+  }
+
+  const word pattern = byte * (word)0x0101010101010101ull;
+  for (; num >= WORD_SIZE; num -= WORD_SIZE) {
+    *(word *)dest = pattern;
+    dest += WORD_SIZE;
+  }
+
+  for (; num; --num) {
+    *dest++ = byte;
+  }
+
+  return destination;
+}
+
+#endif
@@ -0,0 +1,234 @@
+#include "oracle.h"
+#include "context.h"
+#include "memory.h"
+#include "search.h"
+
+static bool has_cell(const uint32_t *cells, const uint8_t index) {
+  return (cells[index / 32] >> (index % 32)) & 1;
+}
+
+static void clear_cells(uint32_t *cells) {
+  for (uint8_t i = 0; i < CELL_BITSET_WORDS; ++i) {
+    cells[i] = 0;
+  }
+}
+
+void oracle_reset(Oracle *oracle) {
+  oracle->verdict = SOLVABILITY_UNKNOWN;
+  oracle->phase = ORACLE_START;
+  clear_cells(oracle->culprits);
+}
+
+void oracle_note_move(Oracle *oracle, const uint8_t index,
+                      const SudokuValue previous, const SudokuValue value) {
+  oracle->stamps[index] = ++oracle->clock;
+  if (oracle->phase != ORACLE_DONE) {
+    oracle_reset(oracle);
+    return;
+  }
+
+  // The witness still completes the board
+  if (oracle->verdict == SOLVABILITY_SOLVABLE &&
+      (value == CELL_VALUE_EMPTY || oracle->witness[index] == value))
+    return;
+
+  // Adding digits never helps, and the new entry is later than the culprits
+  if (oracle->verdict == SOLVABILITY_UNSOLVABLE &&
+      previous == CELL_VALUE_EMPTY)
+    return;
+
+  oracle_reset(oracle);
+}
+
+// Lists the entries of the board in the order they were made
+static void collect_entries(SudokuContext *ctx) {
+  Oracle *oracle = &ctx->oracle;
+  oracle->entry_count = 0;
+
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    const SudokuCell *cell = &ctx->board[i];
+    if (cell->num == CELL_VALUE_EMPTY || cell->prefilled)
+      continue;
+
+    uint8_t position = oracle->entry_count++;
+    while (position > 0 &&
+           oracle->stamps[oracle->entries[position - 1]] > oracle->stamps[i]) {
+      oracle->entries[position] = oracle->entries[position - 1];
+      position--;
+    }
+    oracle->entries[position] = i;
+  }
+}
+
+// Starts a search over the givens and the first count entries not dropped
+static void start_query(SudokuContext *ctx, const uint8_t count) {
+  Oracle *oracle = &ctx->oracle;
+  uint8_t values[BOARD_SIZE];
+
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    const SudokuCell *cell = &ctx->board[i];
+    values[i] = cell->prefilled ? cell->num : CELL_VALUE_EMPTY;
+  }
+
+  for (uint8_t i = 0; i < count; ++i) {
+    const uint8_t cell = oracle->entries[i];
+    if (!has_cell(oracle->dropped, cell))
+      values[cell] = ctx->board[cell].num;
+  }
+
+  search_init(&oracle->search, values);
+}
+
+// A conflict or an empty cell without candidates needs no search
+static bool has_dead_end(SudokuContext *ctx) {
+  if (sudoku_get_conflict_count(ctx))
+    return true;
+
+  const uint16_t *candidates = sudoku_get_candidates(ctx);
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    if (ctx->board[i].num == CELL_VALUE_EMPTY && !candidates[i])
+      return true;
+  }
+
+  return false;
+}
+
+static void finish_unsolvable(SudokuContext *ctx) {
+  Oracle *oracle = &ctx->oracle;
+  clear_cells(oracle->culprits);
+
+  for (uint8_t i = 0; i < oracle->high; ++i) {
+    const uint8_t cell = oracle->entries[i];
+    if (!has_cell(oracle->dropped, cell))
+      oracle->culprits[cell / 32] |= 1u << (cell % 32);
+  }
+
+  oracle->verdict = SOLVABILITY_UNSOLVABLE;
+  oracle->phase = ORACLE_DONE;
+}
+
+// Tries the board without the next earlier entry, or finishes
+static void shrink_next(SudokuContext *ctx) {
+  Oracle *oracle = &ctx->oracle;
+  if (oracle->low == 0) {
+    finish_unsolvable(ctx);
+    return;
+  }
+
+  const uint8_t cell = oracle->entries[oracle->low - 1];
+  oracle->dropped[cell / 32] |= 1u << (cell % 32);
+  start_query(ctx, oracle->high);
+}
+
+// Searches the middle prefix, or starts shrinking once the bisection is over.
+// Prefix high is always unsolvable.
+static void locate_next(SudokuContext *ctx) {
+  Oracle *oracle = &ctx->oracle;
+  if (oracle->low < oracle->high) {
+    start_query(ctx, (oracle->low + oracle->high) / 2);
+    return;
+  }
+
+  // The last entry of the prefix broke the board, so it is always kept. Every
+  // earlier one is dropped if the board stays unsolvable without it.
+  oracle->phase = ORACLE_SHRINK;
+  oracle->low = oracle->high ? oracle->high - 1 : 0;
+  shrink_next(ctx);
+}
+
+static void begin_check(SudokuContext *ctx) {
+  Oracle *oracle = &ctx->oracle;
+  collect_entries(ctx);
+  clear_cells(oracle->dropped);
+  oracle->low = 0;
+  oracle->high = oracle->entry_count;
+
+  if (has_dead_end(ctx)) {
+    oracle->phase = ORACLE_LOCATE;
+    locate_next(ctx);
+    return;
+  }
+
+  oracle->phase = ORACLE_CHECK;
+  start_query(ctx, oracle->entry_count);
+}
+
+static void finish_query(SudokuContext *ctx, const bool solvable) {
+  Oracle *oracle = &ctx->oracle;
+
+  switch (oracle->phase) {
+  case ORACLE_CHECK:
+    if (solvable) {
+      memcpy(oracle->witness, oracle->search.values, BOARD_SIZE);
+      oracle->verdict = SOLVABILITY_SOLVABLE;
+      oracle->phase = ORACLE_DONE;
+    } else {
+      oracle->phase = ORACLE_LOCATE;
+      locate_next(ctx);
+    }
+    break;
+  case ORACLE_LOCATE: {
+    const uint8_t middle = (oracle->low + oracle->high) / 2;
+    if (solvable) {
+      oracle->low = middle + 1;
+    } else {
+      oracle->high = middle;
+    }
+    locate_next(ctx);
+    break;
+  }
+  case ORACLE_SHRINK: {
+    const uint8_t cell = oracle->entries[--oracle->low];
+    if (solvable)
+      oracle->dropped[cell / 32] &= ~(1u << (cell % 32));
+    shrink_next(ctx);
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+Solvability sudoku_check_solvable(SudokuContext *ctx,
+                                  const uint32_t max_nodes) {
+  Oracle *oracle = &ctx->oracle;
+  if (oracle->phase == ORACLE_START)
+    begin_check(ctx);
+
+  // Several short searches can share one budget
+  uint64_t budget = max_nodes;
+  while (oracle->phase != ORACLE_DONE) {
+    const uint64_t nodes = oracle->search.nodes;
+    const SearchResult result = search_next(&oracle->search, budget);
+    const uint64_t used = oracle->search.nodes - nodes;
+    budget -= used < budget ? used : budget;
+
+    if (result == SEARCH_PAUSED)
+      break;
+    finish_query(ctx, result == SEARCH_SOLUTION);
+  }
+
+  return oracle->verdict;
+}
+
+Solvability sudoku_get_solvability(const SudokuContext *ctx) {
+  return ctx->oracle.verdict;
+}
+
+const uint32_t *sudoku_get_unsolvable_entries(const SudokuContext *ctx) {
+  return ctx->oracle.culprits;
+}
+
+// Default context
+
+Solvability check_solvable(const uint32_t max_nodes) {
+  return sudoku_check_solvable(get_default_context(), max_nodes);
+}
+
+Solvability get_solvability(void) {
+  return sudoku_get_solvability(get_default_context());
+}
+
+const uint32_t *get_unsolvable_entries(void) {
+  return sudoku_get_unsolvable_entries(get_default_context());
+}
@@ -0,0 +1,51 @@
+#include "puzzles.h"
+#include "sudoku.h"
+
+typedef struct {
+  const char *givens;   // '.' for blanks
+  const char *solution;
+} EmbeddedPuzzle;
+
+// Generated with generate_puzzle(), seed 0x5d0c0, streams 0-7
+static const EmbeddedPuzzle puzzles[] = {
+    {"......1.36....8..7..7.96..8.4.7.5...7.2....81..1....5.5.8..2.....4.7..2........1.",
+     "489527163635148297127396548846715932752963481391284756518432679964871325273659814"},
+    {"...79.8...496.3...2....4...68.2..31..37...58.......4......37.9......2.....1.....5",
+     "163795824849623751275184936684259317937461582512378469426537198758912643391846275"},
+    {"68.4....21.5..278.........13....7.6......89...6....574.36.2.........4.2..5.8.....",
+     "689471352145392786273586491314957268527648913968213574736125849891734625452869137"},
+    {"....5...3...8......5.4.3..67..54..6.98...275.....9...4......3..5.....87.2.73.....",
+     "672159483341826597859473126723541968984632751165798234498267315536914872217385649"},
+    {"2....3.9.......3.....45.....84...26.1..3...48.....17..6.9....35.....6......937.8.",
+     "268173594495628317713459826384795261157362948926841753679284135832516479541937682"},
+    {".8........4..6....1..7.968....57..36.2..9..1...73......7....8........2.4.3.85....",
+     "986235147742168395153749682819572436325496718467381529671924853598613274234857961"},
+    {"..9.36...8.4.............7..1.3......5...82.9........6...5..982...967.4.....4...1",
+     "579436128824751693361289574216394857453678219798125436647513982182967345935842761"},
+    {".....5.....56..4.....83...624..9..7...65....2..8....1.....8.....7.3.6..49.......1",
+     "619245738385617429427839156243198675196573842758462913534981267871326594962754381"},
+};
+
+#define EMBEDDED_PUZZLE_COUNT (sizeof(puzzles) / sizeof(puzzles[0]))
+
+uint32_t get_embedded_puzzle_count(void) { return EMBEDDED_PUZZLE_COUNT; }
+
+bool sudoku_load_embedded_puzzle(SudokuContext *ctx, const uint32_t index) {
+  if (index >= EMBEDDED_PUZZLE_COUNT)
+    return false;
+
+  uint8_t givens[BOARD_SIZE];
+  uint8_t solution[BOARD_SIZE];
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    const char given = puzzles[index].givens[i];
+    givens[i] = given == '.' ? CELL_VALUE_EMPTY : given - '0';
+    solution[i] = puzzles[index].solution[i] - '0';
+  }
+
+  sudoku_load_board(ctx, givens, solution);
+  return true;
+}
+
+bool load_embedded_puzzle(const uint32_t index) {
+  return sudoku_load_embedded_puzzle(get_default_context(), index);
+}
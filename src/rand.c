@@ -1,10 +1,64 @@
 #include "rand.h"
 
-uint32_t lcg(void) {
-  seed = (1103515245 * seed + 12345) % 2147483648;
-  return seed;
+#define PCG_MULTIPLIER 6364136223846793005ULL
+
+static Rng default_rng = {0x853c49e6748fea9bULL, 0xda3e39cb94b95bdbULL};
+
+void rng_seed(Rng *rng, const uint64_t seed, const uint64_t stream) {
+  rng->state = 0;
+  rng->increment = (stream << 1) | 1;
+  rng_next(rng);
+  rng->state += seed;
+  rng_next(rng);
+}
+
+uint32_t rng_next(Rng *rng) {
+  const uint64_t old = rng->state;
+  rng->state = old * PCG_MULTIPLIER + rng->increment;
+
+  const uint32_t xorshifted = ((old >> 18) ^ old) >> 27;
+  const uint32_t rotation = old >> 59;
+  return (xorshifted >> rotation) | (xorshifted << ((-rotation) & 31));
+}
+
+// Lemire's multiply-and-reject method, which needs a division only when a
+// rejection is possible at all.
+uint32_t rng_bounded(Rng *rng, const uint32_t bound) {
+  uint64_t m = (uint64_t)rng_next(rng) * bound;
+  uint32_t low = (uint32_t)m;
+
+  if (low < bound) {
+    const uint32_t threshold = -bound % bound;
+    while (low < threshold) {
+      m = (uint64_t)rng_next(rng) * bound;
+      low = (uint32_t)m;
+    }
+  }
+
+  return m >> 32;
 }
 
-int random(const int min, const int max) {
-  return lcg() % (max - min + 1) + min;
+// Brown, "Random Number Generation with Arbitrary Strides": composes the LCG
+// step with itself by squaring.
+void rng_advance(Rng *rng, uint64_t delta) {
+  uint64_t multiplier = PCG_MULTIPLIER, increment = rng->increment;
+  uint64_t total_multiplier = 1, total_increment = 0;
+
+  while (delta > 0) {
+    if (delta & 1) {
+      total_multiplier *= multiplier;
+      total_increment = total_increment * multiplier + increment;
+    }
+    increment = (multiplier + 1) * increment;
+    multiplier *= multiplier;
+    delta >>= 1;
+  }
+
+  rng->state = total_multiplier * rng->state + total_increment;
+}
+
+Rng *get_rng(void) { return &default_rng; }
+
+int32_t random(const int32_t min, const int32_t max) {
+  return min + (int32_t)rng_bounded(&default_rng, (uint32_t)(max - min) + 1);
 }
@@ -0,0 +1,245 @@
+#include "search.h"
+#include "trace.h"
+#include "transposition.h"
+#include "units.h"
+
+// Only the solver's search is recorded, not generation or solvability checks
+#define SEARCH_TRACE(search, kind, cell, digit)                                \
+  do {                                                                         \
+    if ((search)->traced)                                                      \
+      TRACE((kind), (cell), (digit), (search)->depth);                         \
+  } while (0)
+
+static inline uint8_t box_of(const uint8_t cell) {
+  return get_box_index(cell % BOARD_SIDE_LENGTH, cell / BOARD_SIDE_LENGTH);
+}
+
+static inline uint16_t allowed_digits(const Search *search,
+                                      const uint8_t cell) {
+  return ALL_DIGITS_MASK & ~(search->rows[cell / BOARD_SIDE_LENGTH] |
+                             search->cols[cell % BOARD_SIDE_LENGTH] |
+                             search->boxes[box_of(cell)]);
+}
+
+static inline void place(Search *search, const uint8_t cell,
+                         const SudokuValue value) {
+  const uint16_t mask = DIGIT_MASK(value);
+  search->values[cell] = value;
+  search->hash ^= zobrist_keys[cell][value];
+  search->rows[cell / BOARD_SIDE_LENGTH] |= mask;
+  search->cols[cell % BOARD_SIDE_LENGTH] |= mask;
+  search->boxes[box_of(cell)] |= mask;
+}
+
+static inline void unplace(Search *search, const uint8_t cell) {
+  const uint16_t mask = ~DIGIT_MASK(search->values[cell]);
+  search->hash ^= zobrist_keys[cell][search->values[cell]];
+  search->values[cell] = CELL_VALUE_EMPTY;
+  search->rows[cell / BOARD_SIDE_LENGTH] &= mask;
+  search->cols[cell % BOARD_SIDE_LENGTH] &= mask;
+  search->boxes[box_of(cell)] &= mask;
+}
+
+// Picks one of the digits in MASK uniformly.
+static inline uint16_t random_digit(Rng *rng, uint16_t mask) {
+  for (uint32_t skip = rng_bounded(rng, __builtin_popcount(mask)); skip;
+       --skip) {
+    mask &= mask - 1;
+  }
+  return mask & -mask;
+}
+
+// Picks the empty cell with the fewest allowed digits. Returns false when the
+// board is full.
+static bool pick_cell(const Search *search, uint8_t *cell) {
+  uint8_t best_count = CELL_VALUE_MAX + 1;
+
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    if (search->values[i] != CELL_VALUE_EMPTY)
+      continue;
+
+    const uint8_t count = __builtin_popcount(allowed_digits(search, i));
+    if (count < best_count) {
+      best_count = count;
+      *cell = i;
+      if (count <= 1)
+        break;
+    }
+  }
+
+  return best_count <= CELL_VALUE_MAX;
+}
+
+bool search_init(Search *search, const uint8_t *values) {
+  for (uint8_t i = 0; i < BOARD_SIDE_LENGTH; ++i) {
+    search->rows[i] = 0;
+    search->cols[i] = 0;
+    search->boxes[i] = 0;
+  }
+
+  search->depth = 0;
+  search->descend = true;
+  search->exhausted = false;
+  search->nodes = 0;
+  search->rng = NULL;
+  search->hash = 0;
+  search->solutions = 0;
+  search->traced = false;
+  zobrist_init();
+
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    search->values[i] = CELL_VALUE_EMPTY;
+  }
+
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    const SudokuValue value = values[i];
+    if (value == CELL_VALUE_EMPTY)
+      continue;
+
+    if (!(allowed_digits(search, i) & DIGIT_MASK(value))) {
+      search->exhausted = true;
+      return false;
+    }
+    place(search, i, value);
+  }
+
+  return true;
+}
+
+SearchResult search_next(Search *search, const uint64_t max_nodes) {
+  if (search->exhausted)
+    return SEARCH_EXHAUSTED;
+
+  const uint64_t limit = max_nodes > SEARCH_UNBOUNDED - search->nodes
+                             ? SEARCH_UNBOUNDED
+                             : search->nodes + max_nodes;
+
+  while (true) {
+    if (search->descend) {
+      uint8_t cell = 0;
+      search->descend = false;
+
+      if (!pick_cell(search, &cell)) {
+        // Resuming after a solution continues with the deepest frame
+        return SEARCH_SOLUTION;
+      }
+
+      SearchFrame *frame = &search->stack[search->depth++];
+      frame->cell = cell;
+      frame->remaining = allowed_digits(search, cell);
+    }
+
+    if (search->depth == 0) {
+      search->exhausted = true;
+      return SEARCH_EXHAUSTED;
+    }
+
+    SearchFrame *frame = &search->stack[search->depth - 1];
+    if (search->values[frame->cell] != CELL_VALUE_EMPTY) {
+      SEARCH_TRACE(search, TRACE_REMOVE, frame->cell,
+                   search->values[frame->cell]);
+      unplace(search, frame->cell);
+    }
+
+    if (!frame->remaining) {
+      SEARCH_TRACE(search, TRACE_BACKTRACK, frame->cell, CELL_VALUE_EMPTY);
+      search->depth--;
+      continue;
+    }
+
+    if (search->nodes >= limit)
+      return SEARCH_PAUSED;
+
+    const uint16_t digit = search->rng
+                               ? random_digit(search->rng, frame->remaining)
+                               : frame->remaining & -frame->remaining;
+    frame->remaining &= ~digit;
+    SEARCH_TRACE(search,
+                 allowed_digits(search, frame->cell) == digit ? TRACE_PROPAGATE
+                                                              : TRACE_PLACE,
+                 frame->cell, __builtin_ctz(digit) + CELL_VALUE_MIN);
+    place(search, frame->cell, __builtin_ctz(digit) + CELL_VALUE_MIN);
+    search->nodes++;
+    search->descend = true;
+  }
+}
+
+// Credits solutions to the frame being explored, or to the whole search.
+static inline void add_solutions(Search *search, const uint8_t solutions) {
+  uint8_t *total = search->depth ? &search->stack[search->depth - 1].solutions
+                                 : &search->solutions;
+  *total += solutions;
+  if (*total > TRANSPOSITION_COUNT_CAP)
+    *total = TRANSPOSITION_COUNT_CAP;
+}
+
+SearchResult search_count_next(Search *search, const uint64_t max_nodes) {
+  if (search->exhausted)
+    return SEARCH_EXHAUSTED;
+
+  const uint64_t limit = max_nodes > SEARCH_UNBOUNDED - search->nodes
+                             ? SEARCH_UNBOUNDED
+                             : search->nodes + max_nodes;
+
+  while (true) {
+    if (search->descend) {
+      uint8_t cell = 0;
+      uint8_t known = 0;
+      search->descend = false;
+
+      if (!pick_cell(search, &cell)) {
+        add_solutions(search, 1);
+      } else if (transposition_probe(search->hash, &known)) {
+        add_solutions(search, known);
+      } else {
+        search->stack[search->depth++] =
+            (SearchFrame){cell, 0, allowed_digits(search, cell)};
+      }
+    }
+
+    if (search->depth == 0) {
+      search->exhausted = true;
+      return SEARCH_EXHAUSTED;
+    }
+
+    SearchFrame *frame = &search->stack[search->depth - 1];
+    if (search->values[frame->cell] != CELL_VALUE_EMPTY)
+      unplace(search, frame->cell);
+
+    // With the cell empty again the hash is back to the frame's board
+    if (!frame->remaining || frame->solutions >= TRANSPOSITION_COUNT_CAP) {
+      transposition_store(search->hash, frame->solutions);
+      search->depth--;
+      add_solutions(search, frame->solutions);
+      continue;
+    }
+
+    if (search->nodes >= limit)
+      return SEARCH_PAUSED;
+
+    const uint16_t digit = frame->remaining & -frame->remaining;
+    frame->remaining &= ~digit;
+    place(search, frame->cell, __builtin_ctz(digit) + CELL_VALUE_MIN);
+    search->nodes++;
+    search->descend = true;
+  }
+}
+
+uint64_t search_count(const uint8_t *values, const uint64_t limit) {
+  Search search;
+  if (!search_init(&search, values))
+    return 0;
+
+  if (limit != 0 && limit <= TRANSPOSITION_COUNT_CAP) {
+    search_count_next(&search, SEARCH_UNBOUNDED);
+    return search.solutions < limit ? search.solutions : limit;
+  }
+
+  uint64_t count = 0;
+  while ((limit == 0 || count < limit) &&
+         search_next(&search, SEARCH_UNBOUNDED) == SEARCH_SOLUTION) {
+    count++;
+  }
+
+  return count;
+}
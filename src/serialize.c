@@ -0,0 +1,210 @@
+#include "serialize.h"
+#include "context.h"
+#include "memory.h"
+#include "search.h"
+
+typedef enum {
+  STATE_CELL_EMPTY,
+  STATE_CELL_GIVEN,
+  STATE_CELL_ENTRY,
+  STATE_CELL_LOCKED,
+} StateCellKind;
+
+// Bit streams, least significant bit first
+typedef struct {
+  uint8_t *data;
+  size_t capacity;
+  size_t bit;
+} BitWriter;
+
+typedef struct {
+  const uint8_t *data;
+  size_t size;
+  size_t bit;
+} BitReader;
+
+static bool write_bits(BitWriter *writer, uint32_t value, uint8_t count) {
+  if (writer->bit + count > writer->capacity * 8)
+    return false;
+
+  for (; count; --count, value >>= 1, ++writer->bit) {
+    uint8_t *byte = &writer->data[writer->bit / 8];
+    if (writer->bit % 8 == 0)
+      *byte = 0;
+    *byte |= (value & 1) << (writer->bit % 8);
+  }
+
+  return true;
+}
+
+static bool read_bits(BitReader *reader, uint32_t *value, uint8_t count) {
+  if (reader->bit + count > reader->size * 8)
+    return false;
+
+  *value = 0;
+  for (uint8_t i = 0; i < count; ++i, ++reader->bit) {
+    const uint8_t byte = reader->data[reader->bit / 8];
+    *value |= (uint32_t)((byte >> (reader->bit % 8)) & 1) << i;
+  }
+
+  return true;
+}
+
+static StateCellKind cell_kind(const SudokuCell *cell) {
+  if (cell->num == CELL_VALUE_EMPTY)
+    return STATE_CELL_EMPTY;
+  if (cell->prefilled)
+    return STATE_CELL_GIVEN;
+  return cell->locked ? STATE_CELL_LOCKED : STATE_CELL_ENTRY;
+}
+
+size_t sudoku_encode_state(const SudokuContext *ctx, uint8_t *out,
+                           const size_t capacity) {
+  BitWriter writer = {out, capacity, 0};
+  if (!write_bits(&writer, STATE_FORMAT_VERSION, STATE_VERSION_BITS))
+    return 0;
+
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    const SudokuCell *cell = &ctx->board[i];
+    const StateCellKind kind = cell_kind(cell);
+    const uint16_t notes = cell->notes & ALL_DIGITS_MASK;
+
+    if (!write_bits(&writer, kind, STATE_CELL_KIND_BITS) ||
+        !write_bits(&writer, notes != 0, 1) ||
+        (kind != STATE_CELL_EMPTY &&
+         !write_bits(&writer, cell->num, STATE_DIGIT_BITS)) ||
+        (notes && !write_bits(&writer, notes, STATE_NOTES_BITS)))
+      return 0;
+  }
+
+  return (writer.bit + 7) / 8;
+}
+
+bool sudoku_decode_state(SudokuContext *ctx, const uint8_t *data,
+                         const size_t size) {
+  BitReader reader = {data, size, 0};
+  uint32_t version = 0;
+  if (!read_bits(&reader, &version, STATE_VERSION_BITS) ||
+      version != STATE_FORMAT_VERSION)
+    return false;
+
+  uint8_t kinds[BOARD_SIZE];
+  uint8_t digits[BOARD_SIZE];
+  uint16_t notes[BOARD_SIZE];
+  uint8_t givens[BOARD_SIZE];
+
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    uint32_t kind = 0, has_notes = 0, digit = CELL_VALUE_EMPTY, mask = 0;
+    if (!read_bits(&reader, &kind, STATE_CELL_KIND_BITS) ||
+        !read_bits(&reader, &has_notes, 1) ||
+        (kind != STATE_CELL_EMPTY &&
+         !read_bits(&reader, &digit, STATE_DIGIT_BITS)) ||
+        (has_notes && !read_bits(&reader, &mask, STATE_NOTES_BITS)))
+      return false;
+
+    if (kind != STATE_CELL_EMPTY &&
+        (digit < CELL_VALUE_MIN || digit > CELL_VALUE_MAX))
+      return false;
+
+    kinds[i] = kind;
+    digits[i] = digit;
+    notes[i] = mask;
+    givens[i] = kind == STATE_CELL_GIVEN ? digit : CELL_VALUE_EMPTY;
+  }
+
+  Search search;
+  search_init(&search, givens);
+  if (search_next(&search, SEARCH_UNBOUNDED) != SEARCH_SOLUTION)
+    return false;
+
+  sudoku_load_board(ctx, givens, search.values);
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    const uint8_t x = i % BOARD_SIDE_LENGTH;
+    const uint8_t y = i / BOARD_SIDE_LENGTH;
+
+    if (kinds[i] == STATE_CELL_ENTRY || kinds[i] == STATE_CELL_LOCKED) {
+      sudoku_set_board_value(ctx, digits[i], x, y, false);
+      ctx->board[i].locked = kinds[i] == STATE_CELL_LOCKED;
+    }
+    if (notes[i])
+      sudoku_set_cell_notes(ctx, notes[i], x, y);
+  }
+
+  // A restored game starts with an empty history
+  journal_clear(&ctx->journal);
+  return true;
+}
+
+// Base64url without padding
+static const char base64_alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static int8_t base64_value(const char c) {
+  if (c >= 'A' && c <= 'Z')
+    return c - 'A';
+  if (c >= 'a' && c <= 'z')
+    return c - 'a' + 26;
+  if (c >= '0' && c <= '9')
+    return c - '0' + 52;
+  if (c == '-')
+    return 62;
+  if (c == '_')
+    return 63;
+  return -1;
+}
+
+size_t sudoku_encode_state_text(const SudokuContext *ctx, char *out,
+                                const size_t capacity) {
+  uint8_t data[STATE_MAX_SIZE];
+  const size_t size = sudoku_encode_state(ctx, data, sizeof(data));
+  const size_t length = (size * 4 + 2) / 3;
+  if (length > capacity)
+    return 0;
+
+  for (size_t i = 0, bit = 0; i < length; ++i, bit += 6) {
+    uint32_t sextet = data[bit / 8] >> (bit % 8);
+    if (bit % 8 > 2 && bit / 8 + 1 < size)
+      sextet |= data[bit / 8 + 1] << (8 - bit % 8);
+    out[i] = base64_alphabet[sextet & 0x3f];
+  }
+
+  return length;
+}
+
+bool sudoku_decode_state_text(SudokuContext *ctx, const char *text,
+                              const size_t length) {
+  if (length > STATE_TEXT_MAX_LENGTH)
+    return false;
+
+  uint8_t data[STATE_MAX_SIZE];
+  memset(data, 0, sizeof(data));
+
+  for (size_t i = 0, bit = 0; i < length; ++i, bit += 6) {
+    const int8_t value = base64_value(text[i]);
+    if (value < 0)
+      return false;
+
+    data[bit / 8] |= value << (bit % 8);
+    if (bit % 8 > 2 && bit / 8 + 1 < sizeof(data))
+      data[bit / 8 + 1] |= value >> (8 - bit % 8);
+  }
+
+  return sudoku_decode_state(ctx, data, length * 6 / 8);
+}
+
+// Default context
+size_t encode_state(uint8_t *out, const size_t capacity) {
+  return sudoku_encode_state(get_default_context(), out, capacity);
+}
+
+bool decode_state(const uint8_t *data, const size_t size) {
+  return sudoku_decode_state(get_default_context(), data, size);
+}
+
+size_t encode_state_text(char *out, const size_t capacity) {
+  return sudoku_encode_state_text(get_default_context(), out, capacity);
+}
+
+bool decode_state_text(const char *text, const size_t length) {
+  return sudoku_decode_state_text(get_default_context(), text, length);
+}
@@ -1,31 +1,383 @@
 #include "sudoku.h"
+#include "arena.h"
+#include "cdcl.h"
+#include "context.h"
+#include "generator.h"
+#include "journal.h"
 #include "log.h"
 #include "memory.h"
+#include "oracle.h"
 #include "rand.h"
+#include "search.h"
 #include "str.h"
+#include "trace.h"
+#include "units.h"
+#include "walloc.h"
 #include <stddef.h>
 
-SudokuCell board[BOARD_SIZE] = {CELL_VALUE_EMPTY};
-SudokuCell solved_board[BOARD_SIZE] = {CELL_VALUE_EMPTY};
-
-SudokuCell stack[STACK_SIZE];
-int32_t stack_top = -1;
+// Solver stack of sudoku_solve(), allocated from the scratch arena per call
+typedef struct {
+  SudokuCell *cells;
+  int32_t top;
+} SolverStack;
 
 // Stack operations
-static bool push(SudokuCell cell) {
-  if (stack_top >= STACK_SIZE - 1)
+static bool push(SolverStack *stack, SudokuCell cell) {
+  if (stack->top >= STACK_SIZE - 1)
     return false;
-  stack[++stack_top] = cell;
+  stack->cells[++stack->top] = cell;
   return true;
 }
 
-static bool pop(SudokuCell *cell) {
-  if (stack_top < 0)
+static bool pop(SolverStack *stack, SudokuCell *cell) {
+  if (stack->top < 0)
     return false;
-  *cell = stack[stack_top--];
+  *cell = stack->cells[stack->top--];
   return true;
 }
 
+// Scratch memory
+//
+// Solver and generator state is allocated from this arena. Every operation
+// takes a mark on entry and rewinds to it on exit, so nested operations (the
+// generator calling the solver) share it without clobbering each other.
+static Arena scratch;
+
+Arena *get_scratch_arena(void) {
+  if (!scratch.base && !arena_init(&scratch, SCRATCH_ARENA_SIZE)) {
+    ERROR("Failed to allocate the scratch arena");
+  }
+
+  return &scratch;
+}
+
+size_t get_scratch_arena_capacity(void) {
+  return get_scratch_arena()->capacity;
+}
+
+size_t get_scratch_arena_high_water(void) {
+  return get_scratch_arena()->high_water;
+}
+
+// Contexts
+static uint32_t created_contexts = 0;
+
+static SudokuContext default_context = {
+    .rng = {0x853c49e6748fea9bULL, 0xda3e39cb94b95bdbULL},
+};
+
+SudokuContext *get_default_context(void) { return &default_context; }
+
+SudokuContext *sudoku_create(void) {
+  SudokuContext *ctx = malloc(sizeof(SudokuContext));
+  if (!ctx) {
+    ERROR("Failed to allocate a context");
+    return NULL;
+  }
+
+  memset(ctx, 0, sizeof(SudokuContext));
+
+  // Seeded from the default generator, on a stream no other context uses
+  Rng *rng = get_rng();
+  const uint64_t seed = ((uint64_t)rng_next(rng) << 32) | rng_next(rng);
+  rng_seed(&ctx->rng, seed, ++created_contexts);
+  return ctx;
+}
+
+void sudoku_destroy(SudokuContext *ctx) {
+  if (ctx != &default_context)
+    free(ctx);
+}
+
+void sudoku_seed(SudokuContext *ctx, const uint64_t seed,
+                 const uint64_t stream) {
+  rng_seed(&ctx->rng, seed, stream);
+}
+
+// Dirty cell tracking
+static void mark_value_dirty(SudokuContext *ctx, const uint8_t index) {
+  ctx->dirty_cells.values[index / 32] |= 1u << (index % 32);
+}
+
+static void mark_notes_dirty(SudokuContext *ctx, const uint8_t index) {
+  ctx->dirty_cells.notes[index / 32] |= 1u << (index % 32);
+}
+
+static void mark_board_dirty(SudokuContext *ctx) {
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    mark_value_dirty(ctx, i);
+    mark_notes_dirty(ctx, i);
+  }
+}
+
+DirtyCells *sudoku_take_dirty_cells(SudokuContext *ctx) {
+  for (uint8_t i = 0; i < CELL_BITSET_WORDS; ++i) {
+    ctx->taken_dirty_cells.values[i] = ctx->dirty_cells.values[i];
+    ctx->taken_dirty_cells.notes[i] = ctx->dirty_cells.notes[i];
+    ctx->dirty_cells.values[i] = 0;
+    ctx->dirty_cells.notes[i] = 0;
+  }
+
+  return &ctx->taken_dirty_cells;
+}
+
+// Board tracking
+//
+// Every unit keeps a count of each digit placed in it. A digit is a candidate
+// of an empty cell while none of the cell's three units contains it, and a
+// filled cell conflicts while one of its units holds its digit twice. A single
+// placement therefore only has to revisit the changed digits of the 20 peers.
+
+static bool is_digit_free(const SudokuContext *ctx, const uint8_t index,
+                          const SudokuValue value) {
+  const uint8_t *units = get_cell_units(index);
+  const uint8_t digit = value - 1;
+
+  return ctx->unit_digit_counts[units[0]][digit] == 0 &&
+         ctx->unit_digit_counts[units[1]][digit] == 0 &&
+         ctx->unit_digit_counts[units[2]][digit] == 0;
+}
+
+static uint16_t compute_candidates(const SudokuContext *ctx,
+                                   const uint8_t index) {
+  if (ctx->board[index].num != CELL_VALUE_EMPTY)
+    return 0;
+
+  uint16_t mask = 0;
+  for (SudokuValue value = CELL_VALUE_MIN; value <= CELL_VALUE_MAX; ++value) {
+    if (is_digit_free(ctx, index, value))
+      mask |= DIGIT_MASK(value);
+  }
+
+  return mask;
+}
+
+static void update_digit_candidate(SudokuContext *ctx, const uint8_t index,
+                                   const SudokuValue value) {
+  if (ctx->board[index].num != CELL_VALUE_EMPTY)
+    return;
+
+  if (is_digit_free(ctx, index, value)) {
+    ctx->candidates[index] |= DIGIT_MASK(value);
+  } else {
+    ctx->candidates[index] &= ~DIGIT_MASK(value);
+  }
+}
+
+static void update_conflict(SudokuContext *ctx, const uint8_t index) {
+  const SudokuValue value = ctx->board[index].num;
+  bool conflicting = false;
+
+  if (value != CELL_VALUE_EMPTY) {
+    const uint8_t *units = get_cell_units(index);
+    for (uint8_t u = 0; u < UNITS_PER_CELL; ++u) {
+      conflicting |= ctx->unit_digit_counts[units[u]][value - 1] > 1;
+    }
+  }
+
+  const uint32_t bit = 1u << (index % 32);
+  const bool was_conflicting = (ctx->conflicts[index / 32] & bit) != 0;
+  if (conflicting == was_conflicting)
+    return;
+
+  ctx->conflicts[index / 32] ^= bit;
+  if (conflicting) {
+    ctx->conflict_count++;
+  } else {
+    ctx->conflict_count--;
+  }
+}
+
+static void ensure_tracking(SudokuContext *ctx) {
+  if (ctx->tracking_ready)
+    return;
+
+  for (uint8_t unit = 0; unit < UNIT_COUNT; ++unit) {
+    for (uint8_t digit = 0; digit < CELL_VALUE_MAX; ++digit) {
+      ctx->unit_digit_counts[unit][digit] = 0;
+    }
+  }
+
+  ctx->correct_cells = 0;
+  ctx->filled_cells = 0;
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    const SudokuValue value = ctx->board[i].num;
+    ctx->correct_cells += value == ctx->solved_board[i].num;
+    if (value == CELL_VALUE_EMPTY)
+      continue;
+
+    ctx->filled_cells++;
+    const uint8_t *units = get_cell_units(i);
+    for (uint8_t u = 0; u < UNITS_PER_CELL; ++u) {
+      ctx->unit_digit_counts[units[u]][value - 1]++;
+    }
+  }
+
+  for (uint8_t i = 0; i < CELL_BITSET_WORDS; ++i) {
+    ctx->conflicts[i] = 0;
+  }
+  ctx->conflict_count = 0;
+
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    ctx->candidates[i] = compute_candidates(ctx, i);
+    update_conflict(ctx, i);
+  }
+
+  ctx->tracking_ready = true;
+}
+
+// Bulk rewrites of board or solved_board (generation, solving, reset) only
+// invalidate the tracking state, it is rebuilt on next use.
+static void invalidate_tracking(SudokuContext *ctx) {
+  ctx->tracking_ready = false;
+  ctx->candidate_epoch++;
+  oracle_reset(&ctx->oracle);
+}
+
+static void write_cell_value(SudokuContext *ctx, const uint8_t index,
+                             const SudokuValue value) {
+  ensure_tracking(ctx);
+
+  const SudokuValue previous = ctx->board[index].num;
+  if (previous == value)
+    return;
+
+  oracle_note_move(&ctx->oracle, index, previous, value);
+
+  // Removing a digit can only widen candidates
+  if (previous != CELL_VALUE_EMPTY)
+    ctx->candidate_epoch++;
+
+  const uint8_t *units = get_cell_units(index);
+  for (uint8_t u = 0; u < UNITS_PER_CELL; ++u) {
+    if (previous != CELL_VALUE_EMPTY)
+      ctx->unit_digit_counts[units[u]][previous - 1]--;
+    if (value != CELL_VALUE_EMPTY)
+      ctx->unit_digit_counts[units[u]][value - 1]++;
+  }
+
+  ctx->correct_cells -= previous == ctx->solved_board[index].num;
+  ctx->correct_cells += value == ctx->solved_board[index].num;
+  ctx->filled_cells -= previous != CELL_VALUE_EMPTY;
+  ctx->filled_cells += value != CELL_VALUE_EMPTY;
+
+  ctx->board[index].num = value;
+  ctx->candidates[index] = compute_candidates(ctx, index);
+  update_conflict(ctx, index);
+
+  const uint8_t *peers = get_cell_peers(index);
+  for (uint8_t i = 0; i < PEER_COUNT; ++i) {
+    const uint8_t peer = peers[i];
+    const SudokuValue peer_value = ctx->board[peer].num;
+
+    if (previous != CELL_VALUE_EMPTY)
+      update_digit_candidate(ctx, peer, previous);
+    if (value != CELL_VALUE_EMPTY)
+      update_digit_candidate(ctx, peer, value);
+
+    if (peer_value != CELL_VALUE_EMPTY &&
+        (peer_value == previous || peer_value == value))
+      update_conflict(ctx, peer);
+  }
+}
+
+const uint16_t *sudoku_get_candidates(SudokuContext *ctx) {
+  ensure_tracking(ctx);
+  return ctx->candidates;
+}
+
+uint32_t sudoku_get_candidate_epoch(const SudokuContext *ctx) {
+  return ctx->candidate_epoch;
+}
+
+const uint32_t *sudoku_get_conflicts(SudokuContext *ctx) {
+  ensure_tracking(ctx);
+  return ctx->conflicts;
+}
+
+uint8_t sudoku_get_conflict_count(SudokuContext *ctx) {
+  ensure_tracking(ctx);
+  return ctx->conflict_count;
+}
+
+bool sudoku_is_board_complete(SudokuContext *ctx) {
+  ensure_tracking(ctx);
+  return ctx->filled_cells == BOARD_SIZE && ctx->conflict_count == 0;
+}
+
+// Undo journal
+static uint8_t journal_cell_state(const SudokuCell *cell) {
+  return cell->num | (cell->locked ? JOURNAL_CELL_LOCKED : 0) |
+         (cell->prefilled ? JOURNAL_CELL_PREFILLED : 0);
+}
+
+// Records how a cell changed since before, if it did
+static void journal_cell(SudokuContext *ctx, const uint8_t index,
+                         const SudokuCell *before) {
+  const SudokuCell *cell = &ctx->board[index];
+  const uint8_t old_state = journal_cell_state(before);
+  const uint8_t new_state = journal_cell_state(cell);
+  if (old_state == new_state && before->notes == cell->notes)
+    return;
+
+  journal_record(&ctx->journal, (JournalEntry){index, 0, old_state, new_state,
+                                               before->notes, cell->notes});
+}
+
+static void apply_journal_state(SudokuContext *ctx, const uint8_t index,
+                                const uint8_t state, const uint16_t notes) {
+  SudokuCell *cell = &ctx->board[index];
+
+  write_cell_value(ctx, index, state & JOURNAL_CELL_DIGIT);
+  cell->locked = (state & JOURNAL_CELL_LOCKED) != 0;
+  cell->prefilled = (state & JOURNAL_CELL_PREFILLED) != 0;
+  cell->notes = notes;
+  mark_value_dirty(ctx, index);
+  mark_notes_dirty(ctx, index);
+}
+
+bool sudoku_undo(SudokuContext *ctx) {
+  uint32_t first = 0, last = 0;
+  if (!journal_undo_step(&ctx->journal, &first, &last))
+    return false;
+
+  for (uint32_t position = last; position-- > first;) {
+    const JournalEntry *entry = journal_entry(&ctx->journal, position);
+    apply_journal_state(ctx, entry->cell, entry->old_state, entry->old_notes);
+  }
+
+  return true;
+}
+
+bool sudoku_redo(SudokuContext *ctx) {
+  uint32_t first = 0, last = 0;
+  if (!journal_redo_step(&ctx->journal, &first, &last))
+    return false;
+
+  for (uint32_t position = first; position < last; ++position) {
+    const JournalEntry *entry = journal_entry(&ctx->journal, position);
+    apply_journal_state(ctx, entry->cell, entry->new_state, entry->new_notes);
+  }
+
+  return true;
+}
+
+bool sudoku_can_undo(const SudokuContext *ctx) {
+  return ctx->journal.cursor != ctx->journal.start;
+}
+
+bool sudoku_can_redo(const SudokuContext *ctx) {
+  return ctx->journal.cursor != ctx->journal.end;
+}
+
+void sudoku_begin_undo_group(SudokuContext *ctx) {
+  journal_begin_group(&ctx->journal);
+}
+
+void sudoku_end_undo_group(SudokuContext *ctx) {
+  journal_end_group(&ctx->journal);
+}
+
 // Utility functions
 static void log_board(const SudokuCell *b) {
   LOGF("Board %dx%d (%d cells)", BOARD_SIDE_LENGTH, BOARD_SIDE_LENGTH,
@@ -56,39 +408,49 @@ uint8_t get_board_index(const uint8_t x, const uint8_t y) {
   return y * BOARD_SIDE_LENGTH + x;
 }
 
-SudokuValue get_board_value(const uint8_t x, const uint8_t y) {
-  return board[get_board_index(x, y)].num;
+SudokuValue sudoku_get_board_value(const SudokuContext *ctx, const uint8_t x,
+                                   const uint8_t y) {
+  return ctx->board[get_board_index(x, y)].num;
 }
 
-bool set_board_value(const SudokuValue value, const uint8_t x, const uint8_t y,
-                     bool prefilled) {
+bool sudoku_set_board_value(SudokuContext *ctx, const SudokuValue value,
+                            const uint8_t x, const uint8_t y, bool prefilled) {
   if (!is_in_range(x, y)) {
     return false;
   }
 
-  SudokuCell *cell = &board[get_board_index(x, y)];
+  const uint8_t index = get_board_index(x, y);
+  SudokuCell *cell = &ctx->board[index];
   if (cell->locked) {
     return false;
   }
 
+  journal_begin_step(&ctx->journal);
+  const SudokuCell before = *cell;
+
   cell->x = x;
   cell->y = y;
-  cell->num = value;
+  write_cell_value(ctx, index, value);
   cell->prefilled = prefilled;
-  cell->locked = is_correct_attempt(value, x, y);
-  reset_cell_notes(x, y);
+  cell->locked = sudoku_is_correct_attempt(ctx, value, x, y);
+  cell->notes = 0;
+  mark_value_dirty(ctx, index);
+  mark_notes_dirty(ctx, index);
 
+  journal_cell(ctx, index, &before);
   return true;
 }
 
-static void force_set_value(const SudokuValue value, const uint8_t x,
-                            const uint8_t y, bool prefilled) {
-  SudokuCell *cell = &board[get_board_index(x, y)];
+static void force_set_value(SudokuContext *ctx, const SudokuValue value,
+                            const uint8_t x, const uint8_t y, bool prefilled) {
+  const uint8_t index = get_board_index(x, y);
+  SudokuCell *cell = &ctx->board[index];
   cell->x = x;
   cell->y = y;
   cell->num = value;
   cell->prefilled = prefilled;
   cell->locked = false;
+  mark_value_dirty(ctx, index);
 }
 
 static bool is_valid_number(const SudokuCell *board, const uint8_t num,
@@ -129,34 +491,23 @@ static bool find_empty_cell(const SudokuCell *board, uint8_t *x, uint8_t *y) {
 }
 
 static void copy_board(SudokuCell *dest, const SudokuCell *src) {
-  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
-    dest[i].x = src[i].x;
-    dest[i].y = src[i].y;
-    dest[i].num = src[i].num;
-    dest[i].prefilled = src[i].prefilled;
-    dest[i].notes = src[i].notes;
-    dest[i].locked = src[i].locked;
-  }
+  memcpy(dest, src, sizeof(SudokuCell) * BOARD_SIZE);
 }
 
 // Sudoku solving functions
-bool solve_sudoku(void) {
-  stack_top = -1;
-
-  copy_board(solved_board, board);
-
+static bool run_solver(SolverStack *stack, SudokuCell *solved_board) {
   uint8_t x = 0, y = 0;
   if (!find_empty_cell(solved_board, &x, &y)) {
     return true;
   }
 
-  if (!push(SUDOKU_CELL(x, y, CELL_VALUE_MIN, 0))) {
+  if (!push(stack, SUDOKU_CELL(x, y, CELL_VALUE_MIN, 0))) {
     return false;
   }
 
   SudokuCell current;
-  while (stack_top >= 0) {
-    if (!pop(&current)) {
+  while (stack->top >= 0) {
+    if (!pop(stack, &current)) {
       break;
     }
 
@@ -169,11 +520,12 @@ bool solve_sudoku(void) {
 
     for (uint8_t num = current.num; num <= CELL_VALUE_MAX; ++num) {
       if (is_valid_number(solved_board, num, current.x, current.y)) {
+        TRACE(TRACE_PLACE, cell_index, num, stack->top + 1);
         solved_board[cell_index].num = num;
 
         // Push the current state back (in case we need to backtrack)
         current.num = num + 1;
-        if (!push(current)) {
+        if (!push(stack, current)) {
           return false;
         }
 
@@ -181,7 +533,7 @@ bool solve_sudoku(void) {
           return true;
         }
 
-        if (!push(SUDOKU_CELL(x, y, CELL_VALUE_MIN, 0))) {
+        if (!push(stack, SUDOKU_CELL(x, y, CELL_VALUE_MIN, 0))) {
           return false;
         }
 
@@ -193,6 +545,7 @@ bool solve_sudoku(void) {
     if (!found) {
       // If no valid number was found, clear the cell and continue with
       // backtracking
+      TRACE(TRACE_BACKTRACK, cell_index, CELL_VALUE_EMPTY, stack->top + 1);
       solved_board[cell_index].num = CELL_VALUE_EMPTY;
     }
   }
@@ -200,125 +553,222 @@ bool solve_sudoku(void) {
   return false;
 }
 
-// Board generation functions
-static void shuffle_array(uint8_t *array, const size_t n) {
-  if (n > 1) {
-    for (size_t i = 0; i < n - 1; i++) {
-      const size_t j = i + random(0, n - i - 1);
-      const uint8_t t = array[j];
-      array[j] = array[i];
-      array[i] = t;
-    }
+static CdclResult solve_with_cdcl(SudokuContext *ctx) {
+  uint8_t values[BOARD_SIZE];
+  uint8_t solution[BOARD_SIZE];
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    values[i] = ctx->solved_board[i].num;
   }
-}
 
-static bool generate_solved_board(void) {
-  uint8_t numbers[BOARD_SIDE_LENGTH];
-  for (uint8_t i = 0; i < BOARD_SIDE_LENGTH; ++i) {
-    numbers[i] = i + 1;
+  const CdclResult result = cdcl_solve_values(values, solution);
+  if (result != CDCL_SAT)
+    return result;
+
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    ctx->solved_board[i].num = solution[i];
   }
+  return CDCL_SAT;
+}
 
-  shuffle_array(numbers, BOARD_SIDE_LENGTH);
+bool sudoku_solve(SudokuContext *ctx) {
+  copy_board(ctx->solved_board, ctx->board);
+  invalidate_tracking(ctx);
 
-  for (uint8_t y = 0; y < BOARD_SIDE_LENGTH; ++y) {
-    for (uint8_t x = 0; x < BOARD_SIDE_LENGTH; ++x) {
-      force_set_value(CELL_VALUE_EMPTY, x, y, false);
-    }
+  // A full clause storage decides nothing, backtracking takes over
+  if (ctx->solver_backend == SOLVER_CDCL) {
+    const CdclResult result = solve_with_cdcl(ctx);
+    if (result != CDCL_FULL)
+      return result == CDCL_SAT;
   }
 
-  uint8_t x = 0, y = 0;
-  find_empty_cell(board, &x, &y);
+  Arena *arena = get_scratch_arena();
+  const size_t mark = arena_mark(arena);
 
-  for (uint8_t i = 0; i < BOARD_SIDE_LENGTH; ++i) {
-    if (is_valid_number(board, numbers[i], x, y)) {
-      board[get_board_index(x, y)].num = numbers[i];
-      if (solve_sudoku()) {
-        return true;
-      }
-      board[get_board_index(x, y)].num = CELL_VALUE_EMPTY;
-    }
+  SolverStack stack = {
+      .cells = arena_alloc(arena, sizeof(SudokuCell) * STACK_SIZE),
+      .top = -1,
+  };
+  if (!stack.cells) {
+    ERROR("Not enough scratch memory for the solver stack");
+    return false;
   }
 
-  return false;
+  const bool solved = run_solver(&stack, ctx->solved_board);
+
+  arena_rewind(arena, mark);
+  return solved;
 }
 
-static uint8_t count_solutions(SudokuCell *board) {
-  uint8_t x = 0, y = 0;
-  if (!find_empty_cell(board, &x, &y)) {
-    return true;
+void sudoku_set_solver_backend(SudokuContext *ctx,
+                               const SolverBackend backend) {
+  ctx->solver_backend = backend;
+}
+
+SolverBackend sudoku_get_solver_backend(const SudokuContext *ctx) {
+  return ctx->solver_backend;
+}
+
+bool sudoku_solve_begin(SudokuContext *ctx) {
+  uint8_t values[BOARD_SIZE];
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    values[i] = ctx->board[i].num;
   }
 
-  uint8_t count = 0;
-  for (uint8_t num = CELL_VALUE_MIN; num <= CELL_VALUE_MAX; ++num) {
-    if (is_valid_number(board, num, x, y)) {
-      board[get_board_index(x, y)].num = num;
-      count += count_solutions(board);
-      if (count > 1) {
-        break;
-      }
-      board[get_board_index(x, y)].num = CELL_VALUE_EMPTY;
+  const bool valid = search_init(&ctx->solve, values);
+  ctx->solve.traced = true;
+  ctx->solve_status = valid ? TASK_RUNNING : TASK_FAILED;
+  return valid;
+}
+
+TaskStatus sudoku_solve_step(SudokuContext *ctx, const uint32_t max_nodes) {
+  if (ctx->solve_status != TASK_RUNNING)
+    return ctx->solve_status;
+
+  switch (search_next(&ctx->solve, max_nodes)) {
+  case SEARCH_PAUSED:
+    break;
+  case SEARCH_EXHAUSTED:
+    ctx->solve_status = TASK_FAILED;
+    break;
+  case SEARCH_SOLUTION:
+    copy_board(ctx->solved_board, ctx->board);
+    for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+      ctx->solved_board[i].num = ctx->solve.values[i];
     }
+    invalidate_tracking(ctx);
+    ctx->solve_status = TASK_DONE;
+    break;
   }
 
-  return count;
+  return ctx->solve_status;
 }
 
-void reset_board(void) {
+TaskStatus sudoku_get_solve_status(const SudokuContext *ctx) {
+  return ctx->solve_status;
+}
+
+void sudoku_reset_board(SudokuContext *ctx) {
+  journal_begin_step(&ctx->journal);
+
   for (int i = 0; i < BOARD_SIZE; ++i) {
-    SudokuCell *cell = &board[i];
+    SudokuCell *cell = &ctx->board[i];
 
     if (cell->prefilled)
       continue;
 
+    const SudokuCell before = *cell;
     cell->num = 0;
     cell->notes = 0;
     cell->locked = false;
+    mark_value_dirty(ctx, i);
+    mark_notes_dirty(ctx, i);
+    journal_cell(ctx, i, &before);
   }
+
+  invalidate_tracking(ctx);
 }
 
-void fill_random_board(void) {
-  if (!generate_solved_board()) {
+void sudoku_load_board(SudokuContext *ctx, const uint8_t *givens,
+                       const uint8_t *solution) {
+  for (uint8_t y = 0; y < BOARD_SIDE_LENGTH; ++y) {
+    for (uint8_t x = 0; x < BOARD_SIDE_LENGTH; ++x) {
+      const uint8_t index = get_board_index(x, y);
+      const SudokuValue value = givens[index];
+
+      force_set_value(ctx, value, x, y, value != CELL_VALUE_EMPTY);
+      ctx->board[index].notes = 0;
+
+      ctx->solved_board[index] = ctx->board[index];
+      ctx->solved_board[index].num = solution[index];
+    }
+  }
+
+  mark_board_dirty(ctx);
+  invalidate_tracking(ctx);
+  journal_clear(&ctx->journal);
+}
+
+// A clue target that is impossible, or too rare to be met within
+// GENERATOR_MAX_ATTEMPTS removal orders, gets a puzzle with these instead
+static const GeneratorOptions default_generator_options = {SYMMETRY_NONE, 0};
+
+static bool generate_with_fallback(SudokuContext *ctx, uint8_t *givens,
+                                   uint8_t *solution) {
+  if (generate_puzzle(&ctx->rng, &ctx->generator_options, givens, solution))
+    return true;
+
+  LOG("No puzzle matches the generator options, using the defaults");
+  return generate_puzzle(&ctx->rng, &default_generator_options, givens,
+                         solution);
+}
+
+void sudoku_fill_random_board(SudokuContext *ctx) {
+  uint8_t givens[BOARD_SIZE];
+  uint8_t solution[BOARD_SIZE];
+  if (!generate_with_fallback(ctx, givens, solution)) {
     LOG("Failed to generate a solved board");
     return;
   }
 
-  memcpy(board, solved_board, sizeof(board));
+  sudoku_load_board(ctx, givens, solution);
+  log_board(ctx->board);
+}
 
-  uint8_t indices[BOARD_SIZE];
-  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
-    indices[i] = i;
-  }
+bool sudoku_prepare_random_board(SudokuContext *ctx) {
+  ctx->has_prepared_board = generate_with_fallback(
+      ctx, ctx->prepared_givens, ctx->prepared_solution);
+  return ctx->has_prepared_board;
+}
+
+bool sudoku_load_prepared_board(SudokuContext *ctx) {
+  if (!ctx->has_prepared_board)
+    return false;
 
-  shuffle_array(indices, BOARD_SIZE);
+  ctx->has_prepared_board = false;
+  sudoku_load_board(ctx, ctx->prepared_givens, ctx->prepared_solution);
+  log_board(ctx->board);
+  return true;
+}
 
-  // Remove numbers from the board until the desired number of clues is reached
-  uint8_t removed = 0;
-  for (uint8_t i = 0; i < BOARD_SIZE && (BOARD_SIZE - removed) > MINIMUM_CLUES;
-       ++i) {
-    const uint8_t index = indices[i];
-    const uint8_t x = index % BOARD_SIDE_LENGTH;
-    const uint8_t y = index / BOARD_SIDE_LENGTH;
+// Restarts a failed generation with the default options
+static void fall_back_to_default_options(SudokuContext *ctx) {
+  const GeneratorOptions *options = &ctx->generation.options;
+  if (ctx->generation.status != TASK_FAILED ||
+      (options->symmetry == default_generator_options.symmetry &&
+       options->clues == default_generator_options.clues))
+    return;
 
-    SudokuValue backup = board[index].num;
-    force_set_value(CELL_VALUE_EMPTY, x, y, false);
+  LOG("No puzzle matches the generator options, using the defaults");
+  generation_begin(&ctx->generation, &ctx->rng, &default_generator_options);
+}
 
-    // Create a copy of the board and solve it to check for uniqueness;
-    SudokuCell temp_board[BOARD_SIZE];
-    memcpy(temp_board, board, sizeof(board));
+void sudoku_generate_begin(SudokuContext *ctx) {
+  generation_begin(&ctx->generation, &ctx->rng, &ctx->generator_options);
+  fall_back_to_default_options(ctx);
+}
 
-    if (count_solutions(temp_board) != 1) {
-      // If the board does not have a unique solution, restore the number
-      force_set_value(backup, x, y, true);
-    } else {
-      removed++;
-    }
+TaskStatus sudoku_generate_step(SudokuContext *ctx, const uint32_t max_nodes) {
+  Generation *generation = &ctx->generation;
+  if (generation->status != TASK_RUNNING)
+    return generation->status;
+
+  generation_step(generation, max_nodes);
+  fall_back_to_default_options(ctx);
+  if (generation->status == TASK_DONE) {
+    memcpy(ctx->prepared_givens, generation->givens, BOARD_SIZE);
+    memcpy(ctx->prepared_solution, generation->solution, BOARD_SIZE);
+    ctx->has_prepared_board = true;
   }
 
-  log_board(board);
+  return generation->status;
+}
+
+TaskStatus sudoku_get_generate_status(const SudokuContext *ctx) {
+  return ctx->generation.status;
 }
 
 // Test functions
-void fill_test_board(void) {
+void sudoku_fill_test_board(SudokuContext *ctx) {
   static const SudokuValue b[BOARD_SIDE_LENGTH][BOARD_SIDE_LENGTH] = {
       {5, 3, 0, 2, 7, 4, 6, 8, 9}, {6, 2, 8, 1, 0, 5, 3, 4, 7},
       {4, 9, 7, 3, 6, 8, 1, 2, 5}, {1, 4, 2, 5, 3, 6, 7, 9, 8},
@@ -329,9 +779,11 @@ void fill_test_board(void) {
 
   for (SudokuValue y = 0; y < BOARD_SIDE_LENGTH; ++y) {
     for (SudokuValue x = 0; x < BOARD_SIDE_LENGTH; ++x) {
-      set_board_value(b[y][x], x, y, b[y][x] != 0);
+      sudoku_set_board_value(ctx, b[y][x], x, y, b[y][x] != 0);
     }
   }
+
+  journal_clear(&ctx->journal);
 }
 
 // Board accessors
@@ -339,47 +791,53 @@ uint8_t get_board_side_length(void) { return BOARD_SIDE_LENGTH; }
 
 uint8_t get_board_size(void) { return BOARD_SIZE; }
 
-SudokuCell *get_board(void) { return board; }
+SudokuCell *sudoku_get_board(SudokuContext *ctx) { return ctx->board; }
 
-SudokuCell *get_solved_board(void) { return solved_board; }
-
-bool is_correct_attempt(const SudokuValue value, const uint8_t x,
-                        const uint8_t y) {
-  return value == solved_board[get_board_index(x, y)].num;
+SudokuCell *sudoku_get_solved_board(SudokuContext *ctx) {
+  return ctx->solved_board;
 }
 
-bool is_board_solved() {
-  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
-    if (board[i].num != solved_board[i].num) {
-      return false;
-    }
-  }
+bool sudoku_is_correct_attempt(const SudokuContext *ctx,
+                               const SudokuValue value, const uint8_t x,
+                               const uint8_t y) {
+  return value == ctx->solved_board[get_board_index(x, y)].num;
+}
 
-  return true;
+bool sudoku_is_board_solved(SudokuContext *ctx) {
+  ensure_tracking(ctx);
+  return ctx->correct_cells == BOARD_SIZE;
 }
 
 // Notes
-bool toggle_cell_note(const uint16_t note, const uint8_t x, const uint8_t y) {
+bool sudoku_toggle_cell_note(SudokuContext *ctx, const uint16_t note,
+                             const uint8_t x, const uint8_t y) {
   if (!is_in_range(x, y)) {
     return false;
   }
 
-  SudokuCell *cell = &board[get_board_index(x, y)];
+  SudokuCell *cell = &ctx->board[get_board_index(x, y)];
+  journal_begin_step(&ctx->journal);
+  const SudokuCell before = *cell;
 
   const uint16_t note_mask = (1 << note);
 
   cell->notes ^= note_mask;
+  mark_notes_dirty(ctx, get_board_index(x, y));
+  journal_cell(ctx, get_board_index(x, y), &before);
 
   return true;
 }
 
-bool set_cell_note(const bool on, const uint16_t note, const uint8_t x,
-                   const uint8_t y) {
+bool sudoku_set_cell_note(SudokuContext *ctx, const bool on,
+                          const uint16_t note, const uint8_t x,
+                          const uint8_t y) {
   if (!is_in_range(x, y)) {
     return false;
   }
 
-  SudokuCell *cell = &board[get_board_index(x, y)];
+  SudokuCell *cell = &ctx->board[get_board_index(x, y)];
+  journal_begin_step(&ctx->journal);
+  const SudokuCell before = *cell;
 
   const uint16_t note_mask = (1 << note);
 
@@ -388,84 +846,227 @@ bool set_cell_note(const bool on, const uint16_t note, const uint8_t x,
   } else {
     cell->notes &= ~note_mask;
   }
+  mark_notes_dirty(ctx, get_board_index(x, y));
+  journal_cell(ctx, get_board_index(x, y), &before);
 
   return true;
 }
 
-int16_t get_cell_notes(const uint8_t x, const uint8_t y) {
-  return !is_in_range(x, y) ? (&board[get_board_index(x, y)])->notes : -1;
+int16_t sudoku_get_cell_notes(const SudokuContext *ctx, const uint8_t x,
+                              const uint8_t y) {
+  return is_in_range(x, y) ? ctx->board[get_board_index(x, y)].notes : -1;
 }
 
-bool get_cell_note(const uint16_t note, const uint8_t x, const uint8_t y) {
+bool sudoku_get_cell_note(const SudokuContext *ctx, const uint16_t note,
+                          const uint8_t x, const uint8_t y) {
   if (!is_in_range(x, y)) {
     return false;
   }
 
-  SudokuCell *cell = &board[get_board_index(x, y)];
+  const SudokuCell *cell = &ctx->board[get_board_index(x, y)];
 
   return ((1 << note) & cell->notes) != 0;
 }
 
-bool set_cell_notes(const uint16_t notes, const uint8_t x, const uint8_t y) {
+bool sudoku_set_cell_notes(SudokuContext *ctx, const uint16_t notes,
+                           const uint8_t x, const uint8_t y) {
   if (!is_in_range(x, y)) {
     return false;
   }
 
-  SudokuCell *cell = &board[get_board_index(x, y)];
+  SudokuCell *cell = &ctx->board[get_board_index(x, y)];
+  journal_begin_step(&ctx->journal);
+  const SudokuCell before = *cell;
+
   cell->notes = notes;
+  mark_notes_dirty(ctx, get_board_index(x, y));
+  journal_cell(ctx, get_board_index(x, y), &before);
 
   return true;
 }
 
-bool reset_cell_notes(const uint8_t x, const uint8_t y) {
-  return set_cell_notes(0, x, y);
+bool sudoku_reset_cell_notes(SudokuContext *ctx, const uint8_t x,
+                             const uint8_t y) {
+  return sudoku_set_cell_notes(ctx, 0, x, y);
 }
 
-void cleanup_invalid_notes(const uint8_t x, const uint8_t y) {
-  const SudokuCell cell = board[get_board_index(x, y)];
+void sudoku_cleanup_invalid_notes(SudokuContext *ctx, const uint8_t x,
+                                  const uint8_t y) {
+  if (!is_in_range(x, y))
+    return;
+
+  const uint8_t index = get_board_index(x, y);
+  const SudokuCell cell = ctx->board[index];
 
-  if (cell.num == CELL_VALUE_EMPTY || !is_correct_attempt(cell.num, x, y))
+  if (cell.num == CELL_VALUE_EMPTY ||
+      !sudoku_is_correct_attempt(ctx, cell.num, x, y))
     return;
 
-  // Notes are 0-indexed (note 0 corresponds to value 1)
-  const uint8_t note_index = cell.num - 1;
+  const uint16_t note_mask = DIGIT_MASK(cell.num);
+  const uint8_t *peers = get_cell_peers(index);
+  journal_begin_step(&ctx->journal);
 
-  // Update row notes
-  for (uint8_t i = 0; i < BOARD_SIDE_LENGTH; ++i) {
-    if (i == x)
-      continue;
+  for (uint8_t i = 0; i < PEER_COUNT; ++i) {
+    SudokuCell *peer = &ctx->board[peers[i]];
 
-    if (get_cell_note(note_index, i, y)) {
-      set_cell_note(false, note_index, i, y);
+    if (peer->notes & note_mask) {
+      const SudokuCell before = *peer;
+      peer->notes &= ~note_mask;
+      mark_notes_dirty(ctx, peers[i]);
+      journal_cell(ctx, peers[i], &before);
     }
   }
+}
 
-  // Update column notes
-  for (uint8_t i = 0; i < BOARD_SIDE_LENGTH; ++i) {
-    if (i == y)
-      continue;
+void sudoku_auto_fill_notes(SudokuContext *ctx) {
+  ensure_tracking(ctx);
+  journal_begin_step(&ctx->journal);
 
-    if (get_cell_note(note_index, x, i)) {
-      set_cell_note(false, note_index, x, i);
+  for (uint8_t i = 0; i < BOARD_SIZE; ++i) {
+    // Candidates of filled cells are always empty
+    if (ctx->board[i].notes != ctx->candidates[i]) {
+      const SudokuCell before = ctx->board[i];
+      ctx->board[i].notes = ctx->candidates[i];
+      mark_notes_dirty(ctx, i);
+      journal_cell(ctx, i, &before);
     }
   }
+}
 
-  // Update box/subgrid notes
-  const uint8_t box_x = (x / BOX_SIZE) * BOX_SIZE;
-  const uint8_t box_y = (y / BOX_SIZE) * BOX_SIZE;
+// Default context
+SudokuCell *get_board(void) { return sudoku_get_board(&default_context); }
 
-  for (uint8_t i = 0; i < BOX_SIZE; ++i) {
-    for (uint8_t j = 0; j < BOX_SIZE; ++j) {
-      const uint8_t current_x = box_x + j;
-      const uint8_t current_y = box_y + i;
+SudokuCell *get_solved_board(void) {
+  return sudoku_get_solved_board(&default_context);
+}
 
-      // Skip the current cell and cells already handled by row/column logic
-      if (current_x == x || current_y == y)
-        continue;
+SudokuValue get_board_value(const uint8_t x, const uint8_t y) {
+  return sudoku_get_board_value(&default_context, x, y);
+}
 
-      if (get_cell_note(note_index, current_x, current_y)) {
-        set_cell_note(false, note_index, current_x, current_y);
-      }
-    }
-  }
+bool set_board_value(const SudokuValue value, const uint8_t x, const uint8_t y,
+                     bool prefilled) {
+  return sudoku_set_board_value(&default_context, value, x, y, prefilled);
+}
+
+bool solve_sudoku(void) { return sudoku_solve(&default_context); }
+
+void set_solver_backend(const SolverBackend backend) {
+  sudoku_set_solver_backend(&default_context, backend);
+}
+
+SolverBackend get_solver_backend(void) {
+  return sudoku_get_solver_backend(&default_context);
+}
+
+bool solve_begin(void) { return sudoku_solve_begin(&default_context); }
+
+TaskStatus solve_step(const uint32_t max_nodes) {
+  return sudoku_solve_step(&default_context, max_nodes);
+}
+
+TaskStatus get_solve_status(void) {
+  return sudoku_get_solve_status(&default_context);
+}
+
+bool is_correct_attempt(const SudokuValue value, const uint8_t x,
+                        const uint8_t y) {
+  return sudoku_is_correct_attempt(&default_context, value, x, y);
+}
+
+bool is_board_solved() { return sudoku_is_board_solved(&default_context); }
+
+void reset_board(void) { sudoku_reset_board(&default_context); }
+
+void fill_test_board(void) { sudoku_fill_test_board(&default_context); }
+
+void fill_random_board(void) { sudoku_fill_random_board(&default_context); }
+
+void load_board(const uint8_t *givens, const uint8_t *solution) {
+  sudoku_load_board(&default_context, givens, solution);
+}
+
+bool prepare_random_board(void) {
+  return sudoku_prepare_random_board(&default_context);
+}
+
+bool load_prepared_board(void) {
+  return sudoku_load_prepared_board(&default_context);
+}
+
+void generate_begin(void) { sudoku_generate_begin(&default_context); }
+
+TaskStatus generate_step(const uint32_t max_nodes) {
+  return sudoku_generate_step(&default_context, max_nodes);
+}
+
+TaskStatus get_generate_status(void) {
+  return sudoku_get_generate_status(&default_context);
+}
+
+bool set_cell_note(const bool on, const uint16_t note, const uint8_t x,
+                   const uint8_t y) {
+  return sudoku_set_cell_note(&default_context, on, note, x, y);
+}
+
+bool toggle_cell_note(const uint16_t note, const uint8_t x, const uint8_t y) {
+  return sudoku_toggle_cell_note(&default_context, note, x, y);
+}
+
+bool reset_cell_notes(const uint8_t x, const uint8_t y) {
+  return sudoku_reset_cell_notes(&default_context, x, y);
+}
+
+int16_t get_cell_notes(const uint8_t x, const uint8_t y) {
+  return sudoku_get_cell_notes(&default_context, x, y);
+}
+
+bool get_cell_note(const uint16_t note, const uint8_t x, const uint8_t y) {
+  return sudoku_get_cell_note(&default_context, note, x, y);
+}
+
+bool set_cell_notes(const uint16_t notes, const uint8_t x, const uint8_t y) {
+  return sudoku_set_cell_notes(&default_context, notes, x, y);
+}
+
+void cleanup_invalid_notes(const uint8_t x, const uint8_t y) {
+  sudoku_cleanup_invalid_notes(&default_context, x, y);
 }
+
+void auto_fill_notes(void) { sudoku_auto_fill_notes(&default_context); }
+
+const uint16_t *get_candidates(void) {
+  return sudoku_get_candidates(&default_context);
+}
+
+uint32_t get_candidate_epoch(void) {
+  return sudoku_get_candidate_epoch(&default_context);
+}
+
+const uint32_t *get_conflicts(void) {
+  return sudoku_get_conflicts(&default_context);
+}
+
+uint8_t get_conflict_count(void) {
+  return sudoku_get_conflict_count(&default_context);
+}
+
+bool is_board_complete(void) {
+  return sudoku_is_board_complete(&default_context);
+}
+
+DirtyCells *take_dirty_cells(void) {
+  return sudoku_take_dirty_cells(&default_context);
+}
+
+bool undo(void) { return sudoku_undo(&default_context); }
+
+bool redo(void) { return sudoku_redo(&default_context); }
+
+bool can_undo(void) { return sudoku_can_undo(&default_context); }
+
+bool can_redo(void) { return sudoku_can_redo(&default_context); }
+
+void begin_undo_group(void) { sudoku_begin_undo_group(&default_context); }
+
+void end_undo_group(void) { sudoku_end_undo_group(&default_context); }
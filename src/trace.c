@@ -0,0 +1,41 @@
+#include "trace.h"
+
+#ifdef SUDOKU_TRACE
+TraceRing trace_ring;
+
+bool is_trace_available(void) { return true; }
+
+void trace_set_enabled(const bool enabled) { trace_ring.enabled = enabled; }
+
+uint32_t trace_read(TraceEvent *out, const uint32_t capacity) {
+  uint32_t read = 0;
+
+  while (read < capacity && trace_ring.tail != trace_ring.head) {
+    out[read++] = trace_ring.events[trace_ring.tail++ & (TRACE_CAPACITY - 1)];
+  }
+
+  return read;
+}
+
+uint32_t get_trace_dropped(void) { return trace_ring.dropped; }
+
+void trace_clear(void) {
+  trace_ring.tail = trace_ring.head;
+  trace_ring.dropped = 0;
+}
+#else
+// Without tracing the ring is not even allocated
+bool is_trace_available(void) { return false; }
+
+void trace_set_enabled(const bool enabled) { (void)enabled; }
+
+uint32_t trace_read(TraceEvent *out, const uint32_t capacity) {
+  (void)out;
+  (void)capacity;
+  return 0;
+}
+
+uint32_t get_trace_dropped(void) { return 0; }
+
+void trace_clear(void) {}
+#endif
@@ -0,0 +1,94 @@
+#include "transposition.h"
+#include "memory.h"
+#include "rand.h"
+#include "walloc.h"
+
+// Fixed so hashes mean the same thing in every session
+#define ZOBRIST_SEED 0x2b992ddfa23249d6ULL
+
+#define COUNT_BITS 3ULL
+
+uint64_t zobrist_keys[BOARD_SIZE][CELL_VALUE_MAX + 1];
+static bool zobrist_ready = false;
+
+static TranspositionTable table = {.bits = TRANSPOSITION_DEFAULT_BITS};
+
+void zobrist_init(void) {
+  if (zobrist_ready)
+    return;
+
+  Rng rng;
+  rng_seed(&rng, ZOBRIST_SEED, 0);
+  for (uint8_t cell = 0; cell < BOARD_SIZE; ++cell) {
+    for (uint8_t value = CELL_VALUE_MIN; value <= CELL_VALUE_MAX; ++value) {
+      const uint64_t high = rng_next(&rng);
+      zobrist_keys[cell][value] = high << 32 | rng_next(&rng);
+    }
+  }
+
+  zobrist_ready = true;
+}
+
+static bool allocate_table(void) {
+  const size_t size = sizeof(uint64_t) << table.bits;
+  table.entries = malloc(size);
+  if (!table.entries) {
+    table.bits = 0;
+    return false;
+  }
+
+  memset(table.entries, 0, size);
+  return true;
+}
+
+static inline uint64_t *slot(const uint64_t key) {
+  return &table.entries[key >> (64 - table.bits)];
+}
+
+bool transposition_probe(const uint64_t key, uint8_t *count) {
+  if (!table.entries)
+    return false;
+
+  table.probes++;
+  const uint64_t entry = *slot(key);
+  if (!(entry & COUNT_BITS) || (entry ^ key) & ~COUNT_BITS)
+    return false;
+
+  table.hits++;
+  *count = (entry & COUNT_BITS) - 1;
+  return true;
+}
+
+void transposition_store(const uint64_t key, const uint8_t count) {
+  if (!table.entries)
+    return;
+
+  table.stores++;
+  *slot(key) = (key & ~COUNT_BITS) | (count + 1);
+}
+
+bool set_transposition_table_bits(const uint8_t bits) {
+  free(table.entries);
+  table.entries = NULL;
+  table.bits = bits > TRANSPOSITION_MAX_BITS ? TRANSPOSITION_MAX_BITS : bits;
+  clear_transposition_table();
+
+  return !table.bits || allocate_table();
+}
+
+uint8_t get_transposition_table_bits(void) { return table.bits; }
+
+void clear_transposition_table(void) {
+  if (table.entries)
+    memset(table.entries, 0, sizeof(uint64_t) << table.bits);
+
+  table.probes = 0;
+  table.hits = 0;
+  table.stores = 0;
+}
+
+uint64_t get_transposition_probes(void) { return table.probes; }
+
+uint64_t get_transposition_hits(void) { return table.hits; }
+
+uint64_t get_transposition_stores(void) { return table.stores; }
@@ -0,0 +1,71 @@
+#include "units.h"
+
+static uint8_t unit_cells[UNIT_COUNT][BOARD_SIDE_LENGTH];
+static uint8_t cell_units[BOARD_SIZE][UNITS_PER_CELL];
+static uint8_t cell_peers[BOARD_SIZE][PEER_COUNT];
+static bool units_ready = false;
+
+uint8_t get_box_index(const uint8_t x, const uint8_t y) {
+  return (y / BOX_SIZE) * BOX_SIZE + x / BOX_SIZE;
+}
+
+static void init_units(void) {
+  for (uint8_t y = 0; y < BOARD_SIDE_LENGTH; ++y) {
+    for (uint8_t x = 0; x < BOARD_SIDE_LENGTH; ++x) {
+      const uint8_t index = get_board_index(x, y);
+      const uint8_t box = get_box_index(x, y);
+      const uint8_t box_offset = (y % BOX_SIZE) * BOX_SIZE + x % BOX_SIZE;
+
+      unit_cells[ROW_UNIT(y)][x] = index;
+      unit_cells[COL_UNIT(x)][y] = index;
+      unit_cells[BOX_UNIT(box)][box_offset] = index;
+
+      cell_units[index][0] = ROW_UNIT(y);
+      cell_units[index][1] = COL_UNIT(x);
+      cell_units[index][2] = BOX_UNIT(box);
+    }
+  }
+
+  for (uint8_t index = 0; index < BOARD_SIZE; ++index) {
+    const uint8_t x = index % BOARD_SIDE_LENGTH;
+    const uint8_t y = index / BOARD_SIDE_LENGTH;
+    uint8_t count = 0;
+
+    // Row and column first, then the box cells not already covered by them
+    for (uint8_t i = 0; i < BOARD_SIDE_LENGTH; ++i) {
+      if (i != x)
+        cell_peers[index][count++] = get_board_index(i, y);
+    }
+    for (uint8_t i = 0; i < BOARD_SIDE_LENGTH; ++i) {
+      if (i != y)
+        cell_peers[index][count++] = get_board_index(x, i);
+    }
+
+    const uint8_t *box = unit_cells[cell_units[index][2]];
+    for (uint8_t i = 0; i < BOARD_SIDE_LENGTH; ++i) {
+      const uint8_t peer = box[i];
+      if (peer % BOARD_SIDE_LENGTH != x && peer / BOARD_SIDE_LENGTH != y)
+        cell_peers[index][count++] = peer;
+    }
+  }
+
+  units_ready = true;
+}
+
+const uint8_t *get_unit_cells(const uint8_t unit) {
+  if (!units_ready)
+    init_units();
+  return unit_cells[unit];
+}
+
+const uint8_t *get_cell_units(const uint8_t index) {
+  if (!units_ready)
+    init_units();
+  return cell_units[index];
+}
+
+const uint8_t *get_cell_peers(const uint8_t index) {
+  if (!units_ready)
+    init_units();
+  return cell_peers[index];
+}
@@ -20,11 +20,16 @@
 // OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
 // WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+#include "walloc.h"
+
 typedef __SIZE_TYPE__ size_t;
 typedef __UINTPTR_TYPE__ uintptr_t;
 typedef __UINT8_TYPE__ uint8_t;
+typedef __UINT32_TYPE__ uint32_t;
 
+#ifndef NULL
 #define NULL ((void *)0)
+#endif
 
 #define STATIC_ASSERT_EQ(a, b) _Static_assert((a) == (b), "eq")
 
@@ -83,6 +88,7 @@ enum chunk_kind {
 #undef DEFINE_SMALL_OBJECT_CHUNK_KIND
 
       SMALL_OBJECT_CHUNK_KINDS,
+  FREE_LARGE_OBJECT_TAIL = 253,
   FREE_LARGE_OBJECT = 254,
   LARGE_OBJECT = 255
 };
@@ -118,9 +124,18 @@ static unsigned chunk_kind_to_granules(enum chunk_kind kind) {
 // P&~PAGE_MASK, and a chunk index via (P&PAGE_MASK)/CHUNKS_PER_PAGE.  If
 // chunk_kinds[chunk_idx] is [FREE_]LARGE_OBJECT, then the pointer is a large
 // object, otherwise the kind indicates the size in granules of the objects in
-// the chunk.
+// the chunk, and live_objects[chunk_idx] counts how many of them are in use.
+// Chunks whose objects are all free go back to the large object pool; see
+// release_empty_small_object_chunks().
+//
+// The last chunk of a free large object that spans several chunks and does not
+// end on a page boundary is tagged FREE_LARGE_OBJECT_TAIL. The last word of
+// such an object, and of a free single-chunk one, points back to its header.
+// Together with the tag on the chunk following an object, this lets free() find
+// free neighbours in O(1).
 struct page_header {
   uint8_t chunk_kinds[CHUNKS_PER_PAGE];
+  uint8_t live_objects[CHUNKS_PER_PAGE];
 };
 
 struct page {
@@ -131,7 +146,7 @@ struct page {
 };
 
 #define PAGE_HEADER_SIZE (sizeof(struct page_header))
-#define FIRST_ALLOCATABLE_CHUNK 1
+#define FIRST_ALLOCATABLE_CHUNK 2
 STATIC_ASSERT_EQ(PAGE_HEADER_SIZE, FIRST_ALLOCATABLE_CHUNK *CHUNK_SIZE);
 
 static struct page *get_page(void *ptr) {
@@ -158,9 +173,57 @@ static inline void *get_large_object_payload(struct large_object *obj) {
 static inline struct large_object *get_large_object(void *ptr) {
   return (struct large_object *)(((char *)ptr) - LARGE_OBJECT_HEADER_SIZE);
 }
+static inline char *get_large_object_end(struct large_object *obj) {
+  return ((char *)get_large_object_payload(obj)) + obj->size;
+}
+static inline size_t get_large_object_chunks(struct large_object *obj) {
+  return (obj->size + LARGE_OBJECT_HEADER_SIZE) >> CHUNK_SIZE_LOG_2;
+}
+
+// Free large objects are kept on doubly linked lists; the back link lives in
+// the first payload word.
+struct free_large_object {
+  struct large_object header;
+  struct large_object **prev_next;
+};
+
+static inline struct free_large_object *
+as_free_large_object(struct large_object *obj) {
+  return (struct free_large_object *)obj;
+}
+
+// Free large objects are binned by their size in chunks: one bin per size
+// below 8 chunks, then four bins per power of two.  Every object in a bin
+// above the one a request maps to is big enough for it, so finding a fit is
+// mostly a bitmap scan rather than a walk over all free objects.
+#define LARGE_OBJECT_BINS 96
+#define LARGE_OBJECT_BIN_WORDS (LARGE_OBJECT_BINS / 32)
+STATIC_ASSERT_EQ(LARGE_OBJECT_BINS, LARGE_OBJECT_BIN_WORDS * 32);
+
+static unsigned chunks_to_bin(size_t chunks) {
+  if (chunks < 8) {
+    return chunks;
+  }
+  unsigned log2 = 63 - __builtin_clzll(chunks);
+  unsigned bin = (log2 - 1) * 4 + ((chunks >> (log2 - 2)) & 3);
+  return bin < LARGE_OBJECT_BINS ? bin : LARGE_OBJECT_BINS - 1;
+}
 
 static struct freelist *small_object_freelists[SMALL_OBJECT_CHUNK_KINDS];
-static struct large_object *large_objects;
+static struct large_object *large_object_bins[LARGE_OBJECT_BINS];
+static uint32_t large_object_bin_map[LARGE_OBJECT_BIN_WORDS];
+
+STATIC_ASSERT_EQ(SMALL_OBJECT_CHUNK_KINDS, WALLOC_SMALL_OBJECT_CLASSES);
+
+// Bookkeeping for walloc_get_stats().
+static size_t small_objects_in_use[SMALL_OBJECT_CHUNK_KINDS];
+static size_t large_object_bytes_in_use;
+static size_t memory_grow_calls;
+static size_t coalesced_large_objects;
+static size_t released_small_object_chunks;
+
+// Number of chunks of each small object kind with no live objects.
+static size_t empty_small_object_chunks[SMALL_OBJECT_CHUNK_KINDS];
 
 extern void __heap_base;
 static size_t walloc_heap_size;
@@ -187,6 +250,7 @@ static struct page *allocate_pages(size_t payload_size, size_t *n_allocated) {
     if (__builtin_wasm_memory_grow(0, grow >> PAGE_SIZE_LOG_2) == -1) {
       return NULL;
     }
+    memory_grow_calls++;
     walloc_heap_size += grow;
   }
 
@@ -204,72 +268,204 @@ static char *allocate_chunk(struct page *page, unsigned idx,
   return page->chunks[idx].data;
 }
 
-// It's possible for splitting to produce a large object of size 248 (256 minus
-// the header size) -- i.e. spanning a single chunk.  In that case, push the
-// chunk back on the GRANULES_32 small object freelist.
-static void maybe_repurpose_single_chunk_large_objects_head(void) {
-  if (large_objects->size < CHUNK_SIZE) {
-    unsigned idx = get_chunk_index(large_objects);
-    char *ptr = allocate_chunk(get_page(large_objects), idx, GRANULES_32);
-    large_objects = large_objects->next;
-    struct freelist *head = (struct freelist *)ptr;
-    head->next = small_object_freelists[GRANULES_32];
-    small_object_freelists[GRANULES_32] = head;
+static unsigned find_large_object_bin(unsigned from) {
+  for (unsigned word = from / 32; word < LARGE_OBJECT_BIN_WORDS; word++) {
+    uint32_t bits = large_object_bin_map[word];
+    if (word == from / 32) {
+      bits &= ~0u << (from % 32);
+    }
+    if (bits) {
+      return word * 32 + __builtin_ctz(bits);
+    }
+  }
+  return LARGE_OBJECT_BINS;
+}
+
+static void remove_free_large_object(struct large_object *obj) {
+  struct large_object **prev_next = as_free_large_object(obj)->prev_next;
+  *prev_next = obj->next;
+  if (obj->next) {
+    as_free_large_object(obj->next)->prev_next = prev_next;
+  }
+  unsigned bin = chunks_to_bin(get_large_object_chunks(obj));
+  if (!large_object_bins[bin]) {
+    large_object_bin_map[bin / 32] &= ~(1u << (bin % 32));
   }
 }
 
-// If there have been any large-object frees since the last large object
-// allocation, go through the freelist and merge any adjacent objects.
-static int pending_large_object_compact = 0;
-static struct large_object **
-maybe_merge_free_large_object(struct large_object **prev) {
-  struct large_object *obj = *prev;
-  while (1) {
-    char *end = get_large_object_payload(obj) + obj->size;
-    ASSERT_ALIGNED((uintptr_t)end, CHUNK_SIZE);
-    unsigned chunk = get_chunk_index(end);
-    if (chunk < FIRST_ALLOCATABLE_CHUNK) {
-      // Merging can't create a large object that newly spans the header chunk.
-      // This check also catches the end-of-heap case.
-      return prev;
+// Put a free large object into its bin and tag its first and last chunks.
+// Single-chunk objects stay in bin 1, where obtain_small_objects() finds them.
+static void insert_free_large_object(struct large_object *obj) {
+  struct page *page = get_page(obj);
+  unsigned idx = get_chunk_index(obj);
+  size_t chunks = get_large_object_chunks(obj);
+
+  allocate_chunk(page, idx, FREE_LARGE_OBJECT);
+  char *end = get_large_object_end(obj);
+  if ((uintptr_t)end & PAGE_MASK) {
+    unsigned last_idx = get_chunk_index(end - 1);
+    if (last_idx != idx) {
+      allocate_chunk(page, last_idx, FREE_LARGE_OBJECT_TAIL);
     }
-    struct page *page = get_page(end);
-    if (page->header.chunk_kinds[chunk] != FREE_LARGE_OBJECT) {
-      return prev;
+    ((struct large_object **)end)[-1] = obj;
+  }
+
+  unsigned bin = chunks_to_bin(chunks);
+  obj->next = large_object_bins[bin];
+  if (obj->next) {
+    as_free_large_object(obj->next)->prev_next = &obj->next;
+  }
+  as_free_large_object(obj)->prev_next = &large_object_bins[bin];
+  large_object_bins[bin] = obj;
+  large_object_bin_map[bin / 32] |= 1u << (bin % 32);
+}
+
+// Take a free large object of at least CHUNKS chunks out of the bins, if there
+// is one.  The best fit among the first few objects of the bin the request
+// maps to is preferred, then the best fit among the first few objects of the
+// smallest bin above it, all of which fit.  The rest of the request's own bin
+// is only walked before giving up, as growing the heap is worse than that.
+#define LARGE_OBJECT_BIN_PROBES 16
+
+static struct large_object *find_fit_in_bin(unsigned bin, size_t chunks,
+                                            size_t probes) {
+  struct large_object *best = NULL;
+  size_t best_chunks = -1;
+  for (struct large_object *walk = large_object_bins[bin]; walk && probes--;
+       walk = walk->next) {
+    size_t walk_chunks = get_large_object_chunks(walk);
+    if (walk_chunks >= chunks && walk_chunks < best_chunks) {
+      best = walk;
+      best_chunks = walk_chunks;
+      if (best_chunks == chunks)
+        // Not going to do any better than this; just return it.
+        break;
     }
+  }
+  return best;
+}
+
+static struct large_object *take_free_large_object(size_t chunks) {
+  unsigned exact = chunks_to_bin(chunks);
+  struct large_object *obj =
+      find_fit_in_bin(exact, chunks, LARGE_OBJECT_BIN_PROBES);
+
+  if (!obj) {
+    unsigned bin = find_large_object_bin(exact + 1);
+    if (bin < LARGE_OBJECT_BINS) {
+      obj = find_fit_in_bin(bin, chunks, LARGE_OBJECT_BIN_PROBES);
+    } else {
+      obj = find_fit_in_bin(exact, chunks, -1);
+    }
+  }
+
+  if (obj) {
+    ASSERT(get_large_object_chunks(obj) >= chunks);
+    remove_free_large_object(obj);
+  }
+  return obj;
+}
+
+// Merge a newly freed large object with free neighbours in the same page.
+// Merging never crosses a page boundary, as the header of the following page
+// may be live.
+static struct large_object *
+coalesce_free_large_object(struct large_object *obj) {
+  struct page *page = get_page(obj);
+
+  char *end = get_large_object_end(obj);
+  ASSERT_ALIGNED((uintptr_t)end, CHUNK_SIZE);
+  unsigned end_idx = get_chunk_index(end);
+  // This check also catches the end-of-heap case.
+  if (end_idx >= FIRST_ALLOCATABLE_CHUNK &&
+      page->header.chunk_kinds[end_idx] == FREE_LARGE_OBJECT) {
     struct large_object *next = (struct large_object *)end;
+    remove_free_large_object(next);
+    obj->size += LARGE_OBJECT_HEADER_SIZE + next->size;
+    coalesced_large_objects++;
+  }
+
+  unsigned idx = get_chunk_index(obj);
+  uint8_t prev_kind = idx > FIRST_ALLOCATABLE_CHUNK
+                          ? page->header.chunk_kinds[idx - 1]
+                          : LARGE_OBJECT;
+  if (prev_kind == FREE_LARGE_OBJECT_TAIL || prev_kind == FREE_LARGE_OBJECT) {
+    struct large_object *prev = ((struct large_object **)obj)[-1];
+    ASSERT_EQ(get_large_object_end(prev), (char *)obj);
+    remove_free_large_object(prev);
+    prev->size += LARGE_OBJECT_HEADER_SIZE + obj->size;
+    obj = prev;
+    coalesced_large_objects++;
+  }
+
+  return obj;
+}
+
+// Give chunks of the small object kinds in MASK that have no live objects back
+// to the large object pool.  Their objects are dropped from the freelist in a
+// first pass, which keeps the first free object seen in each such chunk on a
+// list of its own and marks the chunk with a live count of
+// RELEASING_SMALL_OBJECT_CHUNK.  The second pass turns those chunks into free
+// large objects, coalescing them with their neighbours.
+#define RELEASING_SMALL_OBJECT_CHUNK 0xff
+
+static void release_empty_small_object_chunks(unsigned mask) {
+  struct freelist *releasing = NULL;
 
-    struct large_object **prev_prev = &large_objects, *walk = large_objects;
-    while (1) {
-      ASSERT(walk);
-      if (walk == next) {
-        obj->size += LARGE_OBJECT_HEADER_SIZE + walk->size;
-        *prev_prev = walk->next;
-        if (prev == &walk->next) {
-          prev = prev_prev;
+  for (unsigned kind = 0; kind < SMALL_OBJECT_CHUNK_KINDS; kind++) {
+    if (!(mask & (1u << kind)) || !empty_small_object_chunks[kind]) {
+      continue;
+    }
+    struct freelist **loc = &small_object_freelists[kind];
+    while (*loc) {
+      struct freelist *obj = *loc;
+      uint8_t *live =
+          &get_page(obj)->header.live_objects[get_chunk_index(obj)];
+      if (*live == 0 || *live == RELEASING_SMALL_OBJECT_CHUNK) {
+        *loc = obj->next;
+        if (*live == 0) {
+          *live = RELEASING_SMALL_OBJECT_CHUNK;
+          obj->next = releasing;
+          releasing = obj;
         }
-        break;
+      } else {
+        loc = &obj->next;
       }
-      prev_prev = &walk->next;
-      walk = walk->next;
     }
+    empty_small_object_chunks[kind] = 0;
+  }
+
+  while (releasing) {
+    struct freelist *next = releasing->next;
+    struct large_object *obj =
+        (struct large_object *)((uintptr_t)releasing & ~CHUNK_MASK);
+    obj->size = CHUNK_SIZE - LARGE_OBJECT_HEADER_SIZE;
+    insert_free_large_object(coalesce_free_large_object(obj));
+    released_small_object_chunks++;
+    releasing = next;
   }
 }
-static void maybe_compact_free_large_objects(void) {
-  if (pending_large_object_compact) {
-    pending_large_object_compact = 0;
-    struct large_object **prev = &large_objects;
-    while (*prev) {
-      prev = &(*maybe_merge_free_large_object(prev))->next;
+
+// Kinds with more than one empty chunk are released whenever a large object or
+// a fresh chunk is allocated; a single empty chunk is kept to avoid churn when
+// a kind keeps going back and forth between zero and one live object.
+static void maybe_release_empty_small_object_chunks(void) {
+  unsigned mask = 0;
+  for (unsigned kind = 0; kind < SMALL_OBJECT_CHUNK_KINDS; kind++) {
+    if (empty_small_object_chunks[kind] > 1) {
+      mask |= 1u << kind;
     }
   }
+  if (mask) {
+    release_empty_small_object_chunks(mask);
+  }
 }
 
 // Allocate a large object with enough space for SIZE payload bytes.  Returns a
 // large object with a header, aligned on a chunk boundary, whose payload size
 // may be larger than SIZE, and whose total size (header included) is
 // chunk-aligned.  Either a suitable allocation is found in the large object
-// freelist, or we ask the OS for some more pages and treat those pages as a
+// bins, or we ask the OS for some more pages and treat those pages as a
 // large object.  If the allocation fits in that large object and there's more
 // than an aligned chunk's worth of data free at the end, the large object is
 // split.
@@ -277,24 +473,16 @@ static void maybe_compact_free_large_objects(void) {
 // The return value's corresponding chunk in the page as starting a large
 // object.
 static struct large_object *allocate_large_object(size_t size) {
-  maybe_compact_free_large_objects();
-  struct large_object *best = NULL, **best_prev = &large_objects;
-  size_t best_size = -1;
-  for (struct large_object **prev = &large_objects, *walk = large_objects; walk;
-       prev = &walk->next, walk = walk->next) {
-    if (walk->size >= size && walk->size < best_size) {
-      best_size = walk->size;
-      best = walk;
-      best_prev = prev;
-      if (best_size + LARGE_OBJECT_HEADER_SIZE ==
-          align(size + LARGE_OBJECT_HEADER_SIZE, CHUNK_SIZE))
-        // Not going to do any better than this; just return it.
-        break;
-    }
-  }
-
-  if (!best) {
-    // The large object freelist doesn't have an object big enough for this
+  maybe_release_empty_small_object_chunks();
+  size_t chunks =
+      align(size + LARGE_OBJECT_HEADER_SIZE, CHUNK_SIZE) >> CHUNK_SIZE_LOG_2;
+  struct large_object *best = take_free_large_object(chunks);
+  size_t best_size;
+
+  if (best) {
+    best_size = best->size;
+  } else {
+    // The large object bins don't have an object big enough for this
     // allocation.  Allocate one or more pages from the OS, and treat that new
     // sequence of pages as a fresh large object.  It will be split if
     // necessary.
@@ -307,7 +495,6 @@ static struct large_object *allocate_large_object(size_t size) {
     char *ptr = allocate_chunk(page, FIRST_ALLOCATABLE_CHUNK, LARGE_OBJECT);
     best = (struct large_object *)ptr;
     size_t page_header = ptr - ((char *)page);
-    best->next = large_objects;
     best->size = best_size =
         n_allocated * PAGE_SIZE - page_header - LARGE_OBJECT_HEADER_SIZE;
     ASSERT(best_size >= size_with_header);
@@ -315,9 +502,6 @@ static struct large_object *allocate_large_object(size_t size) {
 
   allocate_chunk(get_page(best), get_chunk_index(best), LARGE_OBJECT);
 
-  struct large_object *next = best->next;
-  *best_prev = next;
-
   size_t tail_size = (best_size - size) & ~CHUNK_MASK;
   if (tail_size) {
     // The best-fitting object has 1 or more aligned chunks free after the
@@ -329,25 +513,22 @@ static struct large_object *allocate_large_object(size_t size) {
     if (start_page == get_page(end - tail_size - 1)) {
       // The allocation does not span a page boundary; yay.
       ASSERT_ALIGNED((uintptr_t)end, CHUNK_SIZE);
-    } else if (size < PAGE_SIZE - LARGE_OBJECT_HEADER_SIZE - CHUNK_SIZE) {
+    } else if (size < PAGE_SIZE - LARGE_OBJECT_HEADER_SIZE - PAGE_HEADER_SIZE) {
       // If the allocation itself smaller than a page, split off the head, then
       // fall through to maybe split the tail.
       ASSERT_ALIGNED((uintptr_t)end, PAGE_SIZE);
       size_t first_page_size = PAGE_SIZE - (((uintptr_t)start) & PAGE_MASK);
       struct large_object *head = best;
-      allocate_chunk(start_page, get_chunk_index(start), FREE_LARGE_OBJECT);
       head->size = first_page_size;
-      head->next = large_objects;
-      large_objects = head;
-
-      maybe_repurpose_single_chunk_large_objects_head();
+      insert_free_large_object(head);
 
       struct page *next_page = start_page + 1;
       char *ptr =
           allocate_chunk(next_page, FIRST_ALLOCATABLE_CHUNK, LARGE_OBJECT);
       best = (struct large_object *)ptr;
       best->size = best_size =
-          best_size - first_page_size - CHUNK_SIZE - LARGE_OBJECT_HEADER_SIZE;
+          best_size - first_page_size - PAGE_HEADER_SIZE -
+          LARGE_OBJECT_HEADER_SIZE;
       ASSERT(best_size >= size);
       start = get_large_object_payload(best);
       tail_size = (best_size - size) & ~CHUNK_MASK;
@@ -372,20 +553,21 @@ static struct large_object *allocate_large_object(size_t size) {
 
     if (tail_size) {
       struct page *page = get_page(end - tail_size);
-      char *tail_ptr = allocate_chunk(page, tail_idx, FREE_LARGE_OBJECT);
-      struct large_object *tail = (struct large_object *)tail_ptr;
-      tail->next = large_objects;
+      struct large_object *tail =
+          (struct large_object *)page->chunks[tail_idx].data;
       tail->size = tail_size - LARGE_OBJECT_HEADER_SIZE;
-      ASSERT_ALIGNED((uintptr_t)(get_large_object_payload(tail) + tail->size),
-                     CHUNK_SIZE);
-      large_objects = tail;
-
-      maybe_repurpose_single_chunk_large_objects_head();
+      ASSERT_ALIGNED((uintptr_t)get_large_object_end(tail), CHUNK_SIZE);
+      insert_free_large_object(tail);
     }
   }
 
-  ASSERT_ALIGNED((uintptr_t)(get_large_object_payload(best) + best->size),
-                 CHUNK_SIZE);
+  char *end = get_large_object_end(best);
+  ASSERT_ALIGNED((uintptr_t)end, CHUNK_SIZE);
+  if (((uintptr_t)end & PAGE_MASK) &&
+      get_chunk_index(end - 1) != get_chunk_index(best)) {
+    // Clear any stale FREE_LARGE_OBJECT_TAIL from the last chunk.
+    allocate_chunk(get_page(best), get_chunk_index(end - 1), LARGE_OBJECT);
+  }
   return best;
 }
 
@@ -395,13 +577,18 @@ static struct freelist *obtain_small_objects(enum chunk_kind kind) {
   if (*whole_chunk_freelist) {
     chunk = *whole_chunk_freelist;
     *whole_chunk_freelist = (*whole_chunk_freelist)->next;
+    empty_small_object_chunks[GRANULES_32]--;
   } else {
     chunk = allocate_large_object(0);
     if (!chunk) {
       return NULL;
     }
   }
-  char *ptr = allocate_chunk(get_page(chunk), get_chunk_index(chunk), kind);
+  struct page *page = get_page(chunk);
+  unsigned idx = get_chunk_index(chunk);
+  char *ptr = allocate_chunk(page, idx, kind);
+  page->header.live_objects[idx] = 0;
+  empty_small_object_chunks[kind]++;
   char *end = ptr + CHUNK_SIZE;
   struct freelist *next = NULL;
   size_t size = chunk_kind_to_granules(kind) * GRANULE_SIZE;
@@ -432,12 +619,20 @@ static void *allocate_small(enum chunk_kind kind) {
   }
   struct freelist *ret = *loc;
   *loc = ret->next;
+  small_objects_in_use[kind]++;
+  if (get_page(ret)->header.live_objects[get_chunk_index(ret)]++ == 0) {
+    empty_small_object_chunks[kind]--;
+  }
   return (void *)ret;
 }
 
 static void *allocate_large(size_t size) {
   struct large_object *obj = allocate_large_object(size);
-  return obj ? get_large_object_payload(obj) : NULL;
+  if (!obj) {
+    return NULL;
+  }
+  large_object_bytes_in_use += obj->size;
+  return get_large_object_payload(obj);
 }
 
 void *malloc(size_t size) {
@@ -454,15 +649,46 @@ void free(void *ptr) {
   uint8_t kind = page->header.chunk_kinds[chunk];
   if (kind == LARGE_OBJECT) {
     struct large_object *obj = get_large_object(ptr);
-    obj->next = large_objects;
-    large_objects = obj;
-    allocate_chunk(page, chunk, FREE_LARGE_OBJECT);
-    pending_large_object_compact = 1;
+    large_object_bytes_in_use -= obj->size;
+    insert_free_large_object(coalesce_free_large_object(obj));
   } else {
     size_t granules = kind;
     struct freelist **loc = get_small_object_freelist(granules);
     struct freelist *obj = ptr;
     obj->next = *loc;
     *loc = obj;
+    small_objects_in_use[granules]--;
+    if (--page->header.live_objects[chunk] == 0) {
+      empty_small_object_chunks[granules]++;
+    }
   }
 }
+
+void walloc_trim(void) { release_empty_small_object_chunks(-1); }
+
+const struct walloc_stats *walloc_get_stats(void) {
+  static struct walloc_stats stats;
+
+  stats.heap_bytes = walloc_heap_size;
+  for (unsigned i = 0; i < SMALL_OBJECT_CHUNK_KINDS; i++) {
+    stats.small_object_bytes[i] =
+        small_objects_in_use[i] * small_object_granule_sizes[i] * GRANULE_SIZE;
+  }
+  stats.large_object_bytes = large_object_bytes_in_use;
+
+  stats.free_large_objects = 0;
+  stats.largest_free_large_object = 0;
+  for (unsigned bin = 0; bin < LARGE_OBJECT_BINS; bin++) {
+    for (struct large_object *walk = large_object_bins[bin]; walk;
+         walk = walk->next) {
+      stats.free_large_objects++;
+      stats.largest_free_large_object =
+          max(stats.largest_free_large_object, walk->size);
+    }
+  }
+
+  stats.memory_grow_calls = memory_grow_calls;
+  stats.coalesced_large_objects = coalesced_large_objects;
+  stats.released_small_object_chunks = released_small_object_chunks;
+  return &stats;
+}
@@ -1,5 +1,7 @@
 export class Cell {
   public incorrect: boolean = false;
+  // Note bits as last reported by the engine, see SudokuBoard.syncDirtyCells()
+  public notes: number = 0;
   public readonly textItem: HTMLSpanElement | null = null;
   public readonly innerGrid: HTMLDivElement | null = null;
 
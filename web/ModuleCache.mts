@@ -0,0 +1,101 @@
+interface CacheEntry {
+  version: string;
+  module: WebAssembly.Module;
+}
+
+const DB_NAME = "sudoku-wasm";
+const STORE_NAME = "modules";
+// Set once the browser refused to store a module, see mayStoreModules()
+const UNSUPPORTED_KEY = "sudoku-wasm-module-cache";
+
+/**
+ * Keeps the compiled module in IndexedDB keyed by its content hash, so repeat
+ * visits skip the compilation. Most browsers refuse to clone a
+ * WebAssembly.Module into IndexedDB. The first refusal is remembered, and such
+ * browsers never touch the cache again.
+ *
+ * Every failure is treated as a cache miss.
+ */
+export class ModuleCache {
+  private db: Promise<IDBDatabase | null> | null = null;
+
+  /** False once storing a module has failed with a DataCloneError. */
+  static mayStoreModules(): boolean {
+    try {
+      return (
+        "indexedDB" in globalThis &&
+        localStorage.getItem(UNSUPPORTED_KEY) === null
+      );
+    } catch {
+      return false;
+    }
+  }
+
+  async get(
+    name: string,
+    version: string,
+  ): Promise<WebAssembly.Module | null> {
+    const db = await this.open();
+    if (!db) return null;
+
+    try {
+      const entry = await ModuleCache.request<CacheEntry | undefined>(
+        db.transaction(STORE_NAME).objectStore(STORE_NAME).get(name),
+      );
+      // Older builds stored raw bytes here
+      if (entry?.version !== version) return null;
+      return entry.module instanceof WebAssembly.Module ? entry.module : null;
+    } catch {
+      return null;
+    }
+  }
+
+  /** Stores module, replacing whatever older version was cached under name. */
+  async put(
+    name: string,
+    version: string,
+    module: WebAssembly.Module,
+  ): Promise<void> {
+    const db = await this.open();
+    if (!db) return;
+
+    try {
+      const store = db
+        .transaction(STORE_NAME, "readwrite")
+        .objectStore(STORE_NAME);
+      await ModuleCache.request(store.put({ version, module }, name));
+    } catch (error) {
+      if (error instanceof DOMException && error.name === "DataCloneError") {
+        ModuleCache.markUnsupported(db);
+      }
+    }
+  }
+
+  // Opened on first use, so browsers that skip the cache never open it
+  private open(): Promise<IDBDatabase | null> {
+    if (!this.db) {
+      const request = indexedDB.open(DB_NAME, 1);
+      request.onupgradeneeded = () =>
+        request.result.createObjectStore(STORE_NAME);
+      this.db = ModuleCache.request<IDBDatabase>(request).catch(() => null);
+    }
+    return this.db;
+  }
+
+  // Also drops anything an older build left behind
+  private static markUnsupported(db: IDBDatabase): void {
+    try {
+      localStorage.setItem(UNSUPPORTED_KEY, "unsupported");
+      db.transaction(STORE_NAME, "readwrite").objectStore(STORE_NAME).clear();
+    } catch {
+      // Nothing to remember it in, the next visit simply tries again
+    }
+  }
+
+  private static request<T>(request: IDBRequest): Promise<T> {
+    return new Promise((resolve, reject) => {
+      request.onsuccess = () => resolve(request.result);
+      request.onerror = () => reject(request.error);
+    });
+  }
+}
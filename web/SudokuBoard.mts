@@ -1,9 +1,19 @@
 import { Cell } from "./Cell.mjs";
 import { WasmInterface } from "./WasmInterface.mjs";
 import { SudokuUI } from "./SudokuUI.mjs";
-import { GameState } from "./types.mjs";
+import { GameState, HintTechnique, TaskStatus } from "./types.mjs";
 import { EventEmitter } from "./EventEmitter.mjs";
 
+// Search nodes per generation or solve slice, well under a millisecond
+const SEARCH_SLICE_NODES = 2000;
+// Time given to each slice when requestIdleCallback is missing
+const GENERATION_FALLBACK_BUDGET_MS = 4;
+// Time per frame given to a solve the player is waiting for
+const SOLVE_FRAME_BUDGET_MS = 8;
+// Where the game is kept between visits, and the URL fragment of share links
+const SAVED_GAME_KEY = "sudoku-game";
+const SHARED_GAME_PREFIX = "#game=";
+
 export class SudokuBoard {
   public wasmInterface: WasmInterface;
   private ui: SudokuUI;
@@ -12,6 +22,8 @@ export class SudokuBoard {
   private gameState: GameState = GameState.INITIALIZING;
   private notesMode = false;
   private eventEmitter = new EventEmitter();
+  private preparation = 0; // invalidates the slices of older preparations
+  private solveRun = 0; // same for solves, bumped whenever the board changes
 
   constructor(wasmUrl: string, ui: SudokuUI) {
     this.wasmInterface = new WasmInterface(wasmUrl);
@@ -30,13 +42,139 @@ export class SudokuBoard {
       this.wasmInterface.boardSideLength,
     );
 
-    // Initialize the board with a random puzzle
-    this.wasmInterface.fillRandomBoard();
+    // Resume a shared or saved game, otherwise start with a built-in puzzle so
+    // the first paint does not wait for the generator, and generate the next
+    // one once the page is idle
+    if (!this.restoreGame() && !this.wasmInterface.loadEmbeddedBoard()) {
+      this.wasmInterface.fillRandomBoard();
+    }
+    this.wasmInterface.takeDirtyCells();
     this.board = this.wasmInterface.getBoard(cellElements);
+    for (const cell of this.board) cell.incorrect = this.isIncorrect(cell);
     this.gameState = GameState.PLAYING;
     this.eventEmitter.emit("gameStateChanged", this.gameState);
 
     this.ui.drawBoard(this.board);
+    this.schedulePreparedBoard();
+
+    addEventListener("visibilitychange", () => {
+      if (document.visibilityState === "hidden") this.saveGame();
+    });
+    addEventListener("pagehide", () => this.saveGame());
+  }
+
+  /** Link that opens the current game, including entries and notes. */
+  getShareLink(): string {
+    const url = new URL(location.href);
+    url.hash = SHARED_GAME_PREFIX + this.wasmInterface.saveState();
+    return url.href;
+  }
+
+  private restoreGame(): boolean {
+    if (location.hash.startsWith(SHARED_GAME_PREFIX)) {
+      const shared = location.hash.slice(SHARED_GAME_PREFIX.length);
+      history.replaceState(null, "", location.pathname + location.search);
+      if (this.wasmInterface.loadState(shared)) return true;
+    }
+
+    const saved = localStorage.getItem(SAVED_GAME_KEY);
+    return saved !== null && this.wasmInterface.loadState(saved);
+  }
+
+  private saveGame(): void {
+    if (this.gameState === GameState.INITIALIZING) return;
+
+    try {
+      // A solved or given up game is over, the next visit starts a new one
+      if (
+        this.gameState === GameState.SOLVED ||
+        this.gameState === GameState.LOCKED
+      ) {
+        localStorage.removeItem(SAVED_GAME_KEY);
+      } else {
+        localStorage.setItem(SAVED_GAME_KEY, this.wasmInterface.saveState());
+      }
+    } catch {
+      // Storage full or disabled, the game is simply not kept
+    }
+  }
+
+  /**
+   * Generates the next puzzle in small slices while the page is idle, so it
+   * never delays a frame. Calling it again abandons the previous one.
+   */
+  private schedulePreparedBoard(): void {
+    const preparation = ++this.preparation;
+    this.wasmInterface.generateBegin();
+
+    this.runSliced(
+      () => this.wasmInterface.generateStep(SEARCH_SLICE_NODES),
+      () => preparation === this.preparation,
+      false,
+    );
+  }
+
+  /**
+   * Calls `step` until it stops returning TaskStatus.RUNNING, in slices that
+   * run while the page is idle, or once per animation frame when `urgent`.
+   * Stops without calling `done` as soon as `isCurrent` returns false.
+   */
+  private runSliced(
+    step: () => TaskStatus,
+    isCurrent: () => boolean,
+    urgent: boolean,
+    done: (status: TaskStatus) => void = () => {},
+  ): void {
+    const run = (timeRemaining: () => number) => {
+      if (!isCurrent()) return;
+
+      let status = TaskStatus.RUNNING;
+      while (status === TaskStatus.RUNNING && timeRemaining() > 1) {
+        status = step();
+      }
+
+      if (status === TaskStatus.RUNNING) {
+        schedule();
+      } else {
+        done(status);
+      }
+    };
+
+    const runFor = (budget: number) => {
+      const end = performance.now() + budget;
+      run(() => end - performance.now());
+    };
+
+    const schedule = () => {
+      if (urgent) {
+        requestAnimationFrame(() => runFor(SOLVE_FRAME_BUDGET_MS));
+      } else if ("requestIdleCallback" in window) {
+        requestIdleCallback((deadline) => run(() => deadline.timeRemaining()));
+      } else {
+        setTimeout(() => runFor(GENERATION_FALLBACK_BUDGET_MS), 0);
+      }
+    };
+
+    schedule();
+  }
+
+  /**
+   * Pulls the cells changed by the engine since the last call, refreshes their
+   * values and notes and returns their indices for redrawing.
+   */
+  private syncDirtyCells(): Set<number> {
+    const { values, notes } = this.wasmInterface.takeDirtyCells();
+
+    for (const i of values) {
+      const cell = this.board[i];
+      cell.num = this.wasmInterface.getBoardValue(...cell.toArray());
+    }
+    for (const i of notes) {
+      const cell = this.board[i];
+      cell.notes = this.wasmInterface.getCellNotes(...cell.toArray());
+    }
+
+    return new Set([...values, ...notes]);
   }
 
   selectCell(x: number, y: number): void {
@@ -45,7 +183,7 @@ export class SudokuBoard {
     const index = this.wasmInterface.getBoardIndex(x, y);
     this.selectedCell = this.board[index];
 
-    this.ui.drawBoard(this.board, this.selectedCell);
+    this.ui.drawBoard(this.board, this.selectedCell, []);
   }
 
   handleInput(value: number): void {
@@ -58,14 +196,18 @@ export class SudokuBoard {
     }
 
     const [x, y] = this.selectedCell.toArray();
+    ++this.solveRun;
 
-    if (this.notesMode) {
-      this.handleNotesInput(value);
-    } else {
-      this.handleNumberInput(value, x, y);
-    }
+    // One input is one undo step, including the notes it clears
+    this.wasmInterface.groupUndo(() => {
+      if (this.notesMode) {
+        this.handleNotesInput(value);
+      } else {
+        this.handleNumberInput(value, x, y);
+      }
+    });
 
-    this.ui.drawBoard(this.board, this.selectedCell);
+    this.ui.drawBoard(this.board, this.selectedCell, this.syncDirtyCells());
   }
 
   private handleNotesInput(value: number): void {
@@ -112,13 +254,30 @@ export class SudokuBoard {
     }
   }
 
+  /** Solves the board in slices, one per animation frame. */
   solveBoard(): void {
-    if (!this.wasmInterface.solveSudoku()) {
+    const solve = ++this.solveRun;
+    if (!this.wasmInterface.solveBegin()) {
+      console.error("Failed to solve Sudoku");
+      return;
+    }
+
+    this.runSliced(
+      () => this.wasmInterface.solveStep(SEARCH_SLICE_NODES),
+      () => solve === this.solveRun,
+      true,
+      (status) => this.showSolution(status),
+    );
+  }
+
+  private showSolution(status: TaskStatus): void {
+    if (status !== TaskStatus.DONE) {
       console.error("Failed to solve Sudoku");
       return;
     }
 
     const previousState = this.gameState;
+    this.wasmInterface.takeDirtyCells();
     this.board = this.wasmInterface.getSolvedBoard(this.ui.cellElements);
     this.gameState = GameState.LOCKED;
     this.eventEmitter.emit("gameStateChanged", this.gameState, previousState);
@@ -132,27 +291,66 @@ export class SudokuBoard {
     const previousState = this.gameState;
     this.gameState = GameState.PLAYING;
     this.eventEmitter.emit("gameStateChanged", this.gameState, previousState);
-    this.wasmInterface.fillRandomBoard();
+    ++this.solveRun;
+    // Falls back to a blocking generation while the prepared one is running
+    ++this.preparation;
+    if (!this.wasmInterface.loadPreparedBoard()) {
+      this.wasmInterface.fillRandomBoard();
+    }
+    this.wasmInterface.takeDirtyCells();
     this.board = this.wasmInterface.getBoard(this.ui.cellElements);
 
     this.ui.drawBoard(this.board);
+    this.schedulePreparedBoard();
     console.log("Created new board");
   }
 
   resetBoard(): void {
+    ++this.solveRun;
     this.wasmInterface.resetBoard();
+    const dirty = this.syncDirtyCells();
 
     const newBoard = this.wasmInterface.getBoard();
-    for (let i = 0; i < this.board.length; ++i) {
-      const { x, y, num, prefilled } = newBoard[i];
+    for (const i of dirty) {
+      const { x, y, num, prefilled, notes } = newBoard[i];
       this.board[i] = new Cell(x, y, num, prefilled, this.board[i].item);
+      this.board[i].notes = notes;
     }
 
     const previousState = this.gameState;
     this.gameState = GameState.PLAYING;
     this.eventEmitter.emit("gameStateChanged", this.gameState, previousState);
 
-    this.ui.drawBoard(this.board, Cell.invalid());
+    this.ui.drawBoard(this.board, Cell.invalid(), dirty);
+  }
+
+  undo(): void {
+    this.applyHistory(() => this.wasmInterface.undo());
+  }
+
+  redo(): void {
+    this.applyHistory(() => this.wasmInterface.redo());
+  }
+
+  private applyHistory(step: () => boolean): void {
+    if (this.gameState !== GameState.PLAYING || !step()) return;
+    ++this.solveRun;
+
+    const dirty = this.syncDirtyCells();
+    for (const i of dirty) {
+      this.board[i].incorrect = this.isIncorrect(this.board[i]);
+    }
+
+    this.ui.drawBoard(this.board, this.selectedCell, dirty);
+  }
+
+  // Entries that differ from the solution, givens never do
+  private isIncorrect(cell: Cell): boolean {
+    return (
+      cell.num !== 0 &&
+      !cell.prefilled &&
+      !this.wasmInterface.isCorrectAttempt(cell.num, ...cell.toArray())
+    );
   }
 
   toggleNotesMode(): void {
@@ -160,6 +358,37 @@ export class SudokuBoard {
     this.ui.setNotesButtonText(this.notesMode);
   }
 
+  autoFillNotes(): void {
+    if (this.gameState !== GameState.PLAYING) return;
+
+    this.wasmInterface.autoFillNotes();
+    this.ui.drawBoard(this.board, this.selectedCell, this.syncDirtyCells());
+  }
+
+  showHint(): void {
+    if (this.gameState !== GameState.PLAYING) return;
+
+    const hint = this.wasmInterface.findNextStep();
+    if (hint.technique === HintTechnique.NONE) {
+      console.log("No logical step found");
+      return;
+    }
+
+    // Selecting the first target highlights the cell and its units
+    const target = this.board[hint.targets[0]];
+    this.selectCell(target.x, target.y);
+
+    if (hint.eliminations.length === 0) {
+      console.log(
+        `${HintTechnique[hint.technique]}: ${hint.value} at [${target.x}, ${target.y}]`,
+      );
+    } else {
+      console.log(
+        `${HintTechnique[hint.technique]}: removes ${hint.eliminations.length} candidate(s)`,
+      );
+    }
+  }
+
   printBoard(): void {
     this.ui.printBoard();
   }
@@ -38,6 +38,12 @@ export class SudokuController {
     this.ui.notesButtonElement.addEventListener("click", () =>
       this.board.toggleNotesMode(),
     );
+    this.ui.autoNotesButtonElement.addEventListener("click", () =>
+      this.board.autoFillNotes(),
+    );
+    this.ui.hintButtonElement.addEventListener("click", () =>
+      this.board.showHint(),
+    );
 
     this.ui.keyboardElement.querySelectorAll("button").forEach((btn) => {
       btn.addEventListener("click", (e) => {
@@ -47,7 +53,18 @@ export class SudokuController {
     });
 
     addEventListener("keydown", (e) => {
-      if (e.key >= "0" && e.key <= "9") {
+      if (e.ctrlKey || e.metaKey) {
+        const key = e.key.toLowerCase();
+        if (key === "z" && !e.shiftKey) {
+          this.board.undo();
+        } else if (key === "y" || (key === "z" && e.shiftKey)) {
+          this.board.redo();
+        } else {
+          return;
+        }
+
+        e.preventDefault();
+      } else if (e.key >= "0" && e.key <= "9") {
         this.board.handleInput(+e.key);
       }
     });
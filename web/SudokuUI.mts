@@ -2,6 +2,12 @@ import { Cell } from "./Cell.mjs";
 import { printElement } from "./print.mjs";
 import type { WasmInterface } from "./WasmInterface.mjs";
 
+interface Selection {
+  x: number;
+  y: number;
+  num: number;
+}
+
 export class SudokuUI {
   private boardContainer: HTMLDivElement;
   private keyboard: HTMLDivElement;
@@ -10,10 +16,17 @@ export class SudokuUI {
   private printButton: HTMLButtonElement;
   private resetButton: HTMLButtonElement;
   private notesButton: HTMLButtonElement;
+  private autoNotesButton: HTMLButtonElement;
+  private hintButton: HTMLButtonElement;
   private cells: HTMLDivElement[][] = [];
   private wasmInterface: WasmInterface | null = null;
   private timerText: HTMLSpanElement;
   private startTime: number = 0;
+  private pendingCells = new Set<number>();
+  private pendingBoard: Cell[] = [];
+  private pendingSelectedCell: Cell | null = null;
+  private lastSelection: Selection | null = null;
+  private frameRequested = false;
 
   constructor() {
     this.boardContainer = document.getElementById("board") as HTMLDivElement;
@@ -33,6 +46,12 @@ export class SudokuUI {
     this.notesButton = document.getElementById(
       "notes-button",
     ) as HTMLButtonElement;
+    this.autoNotesButton = document.getElementById(
+      "auto-notes-button",
+    ) as HTMLButtonElement;
+    this.hintButton = document.getElementById(
+      "hint-button",
+    ) as HTMLButtonElement;
     this.timerText = document.getElementById(
       "timer-element",
     ) as HTMLSpanElement;
@@ -111,16 +130,12 @@ export class SudokuUI {
 
     cell.innerGrid
       .querySelectorAll("div")
-      .forEach((noteItem: HTMLDivElement): void => {
-        const value = +noteItem.innerText;
-        const notePresent = this.wasmInterface!.getCellNote(
-          value - 1,
-          ...cell.toArray(),
-        );
+      .forEach((noteItem: HTMLDivElement, i: number): void => {
+        const notePresent = (cell.notes & (1 << i)) !== 0;
         noteItem.classList.toggle("note-visible", notePresent);
         noteItem.setAttribute(
           "aria-selected",
-          notePresent && selectedCell!.num === value ? "true" : "false",
+          notePresent && selectedCell?.num === i + 1 ? "true" : "false",
         );
       });
 
@@ -128,7 +143,10 @@ export class SudokuUI {
       cell.item.classList.add("empty-cell");
     }
 
-    if (!selectedCell) return;
+    if (!selectedCell) {
+      cell.item.setAttribute("aria-selected", "false");
+      return;
+    }
 
     const [x, y] = cell.toArray();
     const rowSelected = selectedCell.x === x;
@@ -159,8 +177,67 @@ export class SudokuUI {
     }
   }
 
-  drawBoard(board: Cell[], selectedCell: Cell | null = null): void {
-    for (const cell of board) {
+  /**
+   * Schedules a redraw of the given cell indices, or of the whole board when
+   * `dirty` is null. Cells whose highlighting depends on the previous or the
+   * new selection are added automatically. Redraws are batched into a single
+   * animation frame.
+   */
+  drawBoard(
+    board: Cell[],
+    selectedCell: Cell | null = null,
+    dirty: Iterable<number> | null = null,
+  ): void {
+    if (dirty === null) {
+      board.forEach((_, i) => this.pendingCells.add(i));
+    } else {
+      for (const i of dirty) this.pendingCells.add(i);
+    }
+
+    this.markSelectionCells(board, this.lastSelection);
+    this.lastSelection = selectedCell
+      ? { x: selectedCell.x, y: selectedCell.y, num: selectedCell.num }
+      : null;
+    this.markSelectionCells(board, this.lastSelection);
+
+    this.pendingBoard = board;
+    this.pendingSelectedCell = selectedCell;
+
+    if (this.frameRequested) return;
+    this.frameRequested = true;
+    requestAnimationFrame(() => this.flushBoard());
+  }
+
+  private markSelectionCells(board: Cell[], selection: Selection | null): void {
+    if (!selection || selection.x < 0) return;
+
+    const [subX, subY] = [
+      Math.floor(selection.x / 3),
+      Math.floor(selection.y / 3),
+    ];
+    const noteMask = selection.num > 0 ? 1 << (selection.num - 1) : 0;
+
+    board.forEach((cell, i) => {
+      const [cellSubX, cellSubY] = cell.subgrid();
+      if (
+        cell.x === selection.x ||
+        cell.y === selection.y ||
+        (cellSubX === subX && cellSubY === subY) ||
+        (selection.num > 0 && cell.num === selection.num) ||
+        (cell.num === 0 && (cell.notes & noteMask) !== 0)
+      ) {
+        this.pendingCells.add(i);
+      }
+    });
+  }
+
+  private flushBoard(): void {
+    this.frameRequested = false;
+
+    for (const i of this.pendingCells) {
+      const cell = this.pendingBoard[i];
+      if (!cell) continue;
+
       if (!cell.textItem) {
         throw new Error(
           `Span of the [${cell.x}, ${cell.y}] cell is unavailable.`,
@@ -173,8 +250,10 @@ export class SudokuUI {
         cell.prefilled ? "1" : "0",
       );
 
-      this.updateCellDisplay(cell, selectedCell);
+      this.updateCellDisplay(cell, this.pendingSelectedCell);
     }
+
+    this.pendingCells.clear();
   }
 
   setNotesButtonText(notesMode: boolean): void {
@@ -213,4 +292,12 @@ export class SudokuUI {
   get notesButtonElement(): HTMLButtonElement {
     return this.notesButton;
   }
+
+  get autoNotesButtonElement(): HTMLButtonElement {
+    return this.autoNotesButton;
+  }
+
+  get hintButtonElement(): HTMLButtonElement {
+    return this.hintButton;
+  }
 }
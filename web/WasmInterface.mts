@@ -1,10 +1,48 @@
 import { Wasm } from "./wasm.mjs";
 import { Cell } from "./Cell.mjs";
-import type { WasmExports } from "./types.mjs";
+import type {
+  DirtyCells,
+  HeapStats,
+  Hint,
+  HintElimination,
+  PuzzleId,
+  Solvability,
+  SolverBackend,
+  Symmetry,
+  TaskStatus,
+  TraceEvent,
+  TranspositionStats,
+  WasmExports,
+} from "./types.mjs";
+
+// Layout of the Hint struct from hints.h
+const HINT_MAX_TARGETS = 4;
+const HINT_MAX_ELIMINATIONS = 24;
+const HINT_NO_UNIT = 0xff;
+const HINT_TARGETS_OFFSET = 8;
+const HINT_ELIMINATION_CELLS_OFFSET = HINT_TARGETS_OFFSET + HINT_MAX_TARGETS;
+const HINT_ELIMINATION_MASKS_OFFSET =
+  HINT_ELIMINATION_CELLS_OFFSET + HINT_MAX_ELIMINATIONS;
+
+// Layout of struct walloc_stats from walloc.h, all fields are 32-bit size_t
+const WALLOC_SMALL_OBJECT_CLASSES = 10;
+const WALLOC_STATS_FIELDS = WALLOC_SMALL_OBJECT_CLASSES + 7;
+
+// Size of TraceEvent from trace.h
+const TRACE_EVENT_SIZE = 4;
+
+// STATE_MAX_SIZE and STATE_TEXT_MAX_LENGTH from serialize.h
+const STATE_MAX_SIZE = 163;
+const STATE_TEXT_MAX_LENGTH = 218;
+
+// IMPORT_BUFFER_SIZE from corpus.h
+const IMPORT_BUFFER_SIZE = 65536;
 
 export class WasmInterface {
   private wasm: Wasm<WebAssembly.Exports & WasmExports>;
   private sideLength: number = 0;
+  private sessionSeed: bigint = 0n;
+  private nextPuzzleIndex: number = 0;
 
   constructor(wasmUrl: string) {
     this.wasm = new Wasm<WebAssembly.Exports & WasmExports>(wasmUrl);
@@ -13,6 +51,7 @@ export class WasmInterface {
   async init(): Promise<void> {
     await this.wasm.init();
     this.wasm.exports!.setup(Date.now());
+    this.sessionSeed = BigInt(Date.now());
     this.sideLength = this.wasm.exports!.get_board_side_length();
   }
 
@@ -45,9 +84,12 @@ export class WasmInterface {
       const y = Number((cell >> BigInt(8 * 1)) & BigInt(0xff));
       const num = Number((cell >> BigInt(8 * 2)) & BigInt(0xff));
       const prefilled = Number((cell >> BigInt(8 * 3)) & BigInt(0xff)) !== 0;
+      const notes = Number((cell >> BigInt(8 * 4)) & BigInt(0xffff));
       const cellElement = cellElements ? cellElements[y]?.[x] : null;
 
-      newBoard.push(new Cell(x, y, num, prefilled, cellElement));
+      const newCell = new Cell(x, y, num, prefilled, cellElement);
+      newCell.notes = notes;
+      newBoard.push(newCell);
     }
 
     return newBoard;
@@ -78,6 +120,10 @@ export class WasmInterface {
     return this.wasm.exports!.set_board_value(value, x, y, prefilled);
   }
 
+  getBoardValue(x: number, y: number): number {
+    return this.wasm.exports!.get_board_value(x, y);
+  }
+
   getBoardIndex(x: number, y: number): number {
     return this.wasm.exports!.get_board_index(x, y);
   }
@@ -86,8 +132,195 @@ export class WasmInterface {
     this.wasm.exports!.reset_board();
   }
 
-  fillRandomBoard(): void {
+  /**
+   * Shapes the puzzles generated from now on. A `clues` target asks for
+   * minimal puzzles with exactly that many clues, 0 keeps the default.
+   * Puzzle ids only regenerate the same puzzle under the same options.
+   */
+  setGeneratorOptions(symmetry: Symmetry, clues: number = 0): void {
+    this.wasm.exports!.set_generator_options(symmetry, clues);
+  }
+
+  /**
+   * Generates the next puzzle of this session, or the given one again, and
+   * returns the id it can be regenerated from.
+   */
+  fillRandomBoard(puzzle?: PuzzleId): PuzzleId {
+    const id = puzzle ?? this.nextPuzzleId();
+
+    this.wasm.exports!.seed_puzzle(id.seed, id.index);
     this.wasm.exports!.fill_random_board();
+    return id;
+  }
+
+  /**
+   * Generates the next puzzle of this session without touching the board, so
+   * it can be done while idle. Returns its id, or null if generation failed.
+   */
+  prepareRandomBoard(): PuzzleId | null {
+    const id = this.nextPuzzleId();
+
+    this.wasm.exports!.seed_puzzle(id.seed, id.index);
+    return this.wasm.exports!.prepare_random_board() ? id : null;
+  }
+
+  /**
+   * Starts preparing the next puzzle of this session in slices, see
+   * generateStep(). Returns its id.
+   */
+  generateBegin(): PuzzleId {
+    const id = this.nextPuzzleId();
+
+    this.wasm.exports!.seed_puzzle(id.seed, id.index);
+    this.wasm.exports!.generate_begin();
+    return id;
+  }
+
+  /**
+   * Runs the generation for at most `maxNodes` search nodes. Once it returns
+   * TaskStatus.DONE the puzzle can be shown with loadPreparedBoard().
+   */
+  generateStep(maxNodes: number): TaskStatus {
+    return this.wasm.exports!.generate_step(maxNodes);
+  }
+
+  /** Resumable solveSudoku(), stepped like generateStep(). */
+  solveBegin(): boolean {
+    return this.wasm.exports!.solve_begin();
+  }
+
+  solveStep(maxNodes: number): TaskStatus {
+    return this.wasm.exports!.solve_step(maxNodes);
+  }
+
+  /** Shows the puzzle from prepareRandomBoard(), if there is one left. */
+  loadPreparedBoard(): boolean {
+    return this.wasm.exports!.load_prepared_board();
+  }
+
+  /** Shows one of the puzzles built into the module, picked at random. */
+  loadEmbeddedBoard(): boolean {
+    const count = this.wasm.exports!.get_embedded_puzzle_count();
+    return this.wasm.exports!.load_embedded_puzzle(
+      Math.floor(Math.random() * count),
+    );
+  }
+
+  /**
+   * Parses a puzzle file (81-character lines or .sdk grids) into the corpus
+   * as it streams in. Returns the corpus size and how many lines or grids
+   * were skipped as malformed so far.
+   */
+  async importPuzzles(
+    source: ReadableStream<Uint8Array>,
+  ): Promise<{ count: number; malformed: number }> {
+    const exports = this.wasm.exports!;
+    const buffer = exports.get_import_buffer();
+
+    const reader = source.getReader();
+    try {
+      while (true) {
+        const { done, value: chunk } = await reader.read();
+        if (done) break;
+
+        for (let i = 0; i < chunk.length; i += IMPORT_BUFFER_SIZE) {
+          const part = chunk.subarray(i, i + IMPORT_BUFFER_SIZE);
+          // Memory may have grown while the last part was parsed
+          new Uint8Array(this.wasm.memory!.buffer, buffer, part.length).set(
+            part,
+          );
+          if (!exports.import_chunk(buffer, part.length)) {
+            throw new Error("Out of memory while importing puzzles.");
+          }
+        }
+      }
+    } finally {
+      reader.releaseLock();
+    }
+    if (!exports.import_finish()) {
+      throw new Error("Out of memory while importing puzzles.");
+    }
+
+    return {
+      count: exports.get_corpus_size(),
+      malformed: exports.get_import_malformed(),
+    };
+  }
+
+  getCorpusSize(): number {
+    return this.wasm.exports!.get_corpus_size();
+  }
+
+  /** Shows an imported puzzle, false for a bad index or no solution. */
+  loadCorpusBoard(index: number): boolean {
+    return this.wasm.exports!.load_corpus_puzzle(index);
+  }
+
+  clearCorpus(): void {
+    this.wasm.exports!.clear_corpus();
+  }
+
+  private nextPuzzleId(): PuzzleId {
+    return { seed: this.sessionSeed, index: this.nextPuzzleIndex++ };
+  }
+
+  /**
+   * Packs the board, entries and notes into a versioned blob of at most
+   * STATE_MAX_SIZE bytes. The solution is recomputed when decoding.
+   */
+  encodeState(): Uint8Array {
+    const out = this.allocate(STATE_MAX_SIZE);
+    const size = this.wasm.exports!.encode_state(out, STATE_MAX_SIZE);
+    const state = new Uint8Array(this.wasm.memory!.buffer, out, size).slice();
+
+    this.wasm.exports!.free(out);
+    return state;
+  }
+
+  /** Replaces the board with an encoded state, false if it is invalid. */
+  decodeState(state: Uint8Array): boolean {
+    const data = this.allocate(state.length);
+    new Uint8Array(this.wasm.memory!.buffer, data, state.length).set(state);
+
+    const decoded = this.wasm.exports!.decode_state(data, state.length);
+    this.wasm.exports!.free(data);
+    return decoded;
+  }
+
+  /** Same as encodeState() as URL-safe base64 text. */
+  saveState(): string {
+    const out = this.allocate(STATE_TEXT_MAX_LENGTH);
+    const length = this.wasm.exports!.encode_state_text(
+      out,
+      STATE_TEXT_MAX_LENGTH,
+    );
+    const text = new TextDecoder().decode(
+      new Uint8Array(this.wasm.memory!.buffer, out, length),
+    );
+
+    this.wasm.exports!.free(out);
+    return text;
+  }
+
+  loadState(text: string): boolean {
+    if (text.length > STATE_TEXT_MAX_LENGTH) return false;
+
+    const bytes = new TextEncoder().encode(text);
+    const data = this.allocate(Math.max(bytes.length, 1));
+    new Uint8Array(this.wasm.memory!.buffer, data, bytes.length).set(bytes);
+
+    const loaded = this.wasm.exports!.decode_state_text(data, bytes.length);
+    this.wasm.exports!.free(data);
+    return loaded;
+  }
+
+  private allocate(size: number): number {
+    const pointer = this.wasm.exports!.malloc(size);
+    if (!pointer) {
+      throw new Error("Failed to allocate the state buffer.");
+    }
+
+    return pointer;
   }
 
   fillTestBoard(): void {
@@ -98,6 +331,19 @@ export class WasmInterface {
     return this.wasm.exports!.solve_sudoku();
   }
 
+  /** Solver behind solveSudoku() and countAllSolutions(). */
+  setSolverBackend(backend: SolverBackend): void {
+    this.wasm.exports!.set_solver_backend(backend);
+  }
+
+  getSolverBackend(): SolverBackend {
+    return this.wasm.exports!.get_solver_backend();
+  }
+
+  getCellNotes(x: number, y: number): number {
+    return this.wasm.exports!.get_cell_notes(x, y);
+  }
+
   getCellNote(note: number, x: number, y: number): boolean {
     return this.wasm.exports!.get_cell_note(note, x, y);
   }
@@ -117,4 +363,309 @@ export class WasmInterface {
   cleanupInvalidNotes(x: number, y: number): void {
     this.wasm.exports!.cleanup_invalid_notes(x, y);
   }
+
+  autoFillNotes(): void {
+    this.wasm.exports!.auto_fill_notes();
+  }
+
+  getCandidates(): Uint16Array {
+    return new Uint16Array(
+      this.wasm.memory!.buffer,
+      this.wasm.exports!.get_candidates(),
+      this.wasm.exports!.get_board_size(),
+    );
+  }
+
+  /** Indices of the cells set in the cell bitset at `ptr`. */
+  private readCellBitset(ptr: number): number[] {
+    const size = this.wasm.exports!.get_board_size();
+    const bits = new Uint32Array(
+      this.wasm.memory!.buffer,
+      ptr,
+      Math.ceil(size / 32),
+    );
+
+    const cells: number[] = [];
+    for (let i = 0; i < size; ++i) {
+      if (bits[Math.floor(i / 32)] & (1 << i % 32)) cells.push(i);
+    }
+
+    return cells;
+  }
+
+  getConflicts(): number[] {
+    return this.readCellBitset(this.wasm.exports!.get_conflicts());
+  }
+
+  isBoardComplete(): boolean {
+    return this.wasm.exports!.is_board_complete();
+  }
+
+  /**
+   * Works out whether the board can still be completed, placing at most
+   * `maxNodes` digits per call. Returns Solvability.UNKNOWN until it knows;
+   * meant to be called every frame, it is free while nothing changed.
+   */
+  checkSolvable(maxNodes: number): Solvability {
+    return this.wasm.exports!.check_solvable(maxNodes);
+  }
+
+  getSolvability(): Solvability {
+    return this.wasm.exports!.get_solvability();
+  }
+
+  /**
+   * Earliest entries that left the board unsolvable, empty unless
+   * getSolvability() is Solvability.UNSOLVABLE.
+   */
+  getUnsolvableEntries(): number[] {
+    return this.readCellBitset(this.wasm.exports!.get_unsolvable_entries());
+  }
+
+  findNextStep(): Hint {
+    const view = new DataView(
+      this.wasm.memory!.buffer,
+      this.wasm.exports!.find_next_step(),
+    );
+
+    const targets: number[] = [];
+    for (let i = 0; i < view.getUint8(3); ++i) {
+      targets.push(view.getUint8(HINT_TARGETS_OFFSET + i));
+    }
+
+    const eliminations: HintElimination[] = [];
+    for (let i = 0; i < view.getUint8(4); ++i) {
+      eliminations.push({
+        cell: view.getUint8(HINT_ELIMINATION_CELLS_OFFSET + i),
+        notes: view.getUint16(HINT_ELIMINATION_MASKS_OFFSET + i * 2, true),
+      });
+    }
+
+    const unit = view.getUint8(1);
+    return {
+      technique: view.getUint8(0),
+      unit: unit === HINT_NO_UNIT ? null : unit,
+      value: view.getUint8(2),
+      targets,
+      eliminations,
+    };
+  }
+
+  enumerateBegin(limit: bigint = 0n): boolean {
+    return this.wasm.exports!.enumerate_begin(limit);
+  }
+
+  /**
+   * Returns up to `capacity` further solutions of the board passed to
+   * enumerateBegin(), one digit per cell. An empty result means the
+   * enumeration is done.
+   */
+  enumerateNext(capacity: number): Uint8Array[] {
+    const size = this.wasm.exports!.get_board_size();
+    const out = this.wasm.exports!.malloc(capacity * size);
+    if (!out) {
+      throw new Error("Failed to allocate the solution buffer.");
+    }
+
+    const written = this.wasm.exports!.enumerate_next(out, capacity);
+    const solutions: Uint8Array[] = [];
+    for (let i = 0; i < written; ++i) {
+      solutions.push(
+        new Uint8Array(this.wasm.memory!.buffer, out + i * size, size).slice(),
+      );
+    }
+
+    this.wasm.exports!.free(out);
+    return solutions;
+  }
+
+  generateGrids(count: number): Uint8Array[] {
+    const size = this.wasm.exports!.get_board_size();
+    const out = this.wasm.exports!.malloc(count * size);
+    if (!out) {
+      throw new Error("Failed to allocate the grid buffer.");
+    }
+
+    const written = this.wasm.exports!.generate_grids(out, count);
+    const grids: Uint8Array[] = [];
+    for (let i = 0; i < written; ++i) {
+      grids.push(
+        new Uint8Array(this.wasm.memory!.buffer, out + i * size, size).slice(),
+      );
+    }
+
+    this.wasm.exports!.free(out);
+    return grids;
+  }
+
+  countAllSolutions(limit: bigint = 0n): bigint {
+    return this.wasm.exports!.count_all_solutions(limit);
+  }
+
+  getScratchArenaUsage(): { capacity: number; highWater: number } {
+    return {
+      capacity: this.wasm.exports!.get_scratch_arena_capacity(),
+      highWater: this.wasm.exports!.get_scratch_arena_high_water(),
+    };
+  }
+
+  /**
+   * Resizes the cache of solution counts used by uniqueness checks to 2^bits
+   * entries of 8 bytes, 0 to disable it.
+   */
+  setTranspositionTableBits(bits: number): boolean {
+    return this.wasm.exports!.set_transposition_table_bits(bits);
+  }
+
+  getTranspositionStats(): TranspositionStats {
+    return {
+      bits: this.wasm.exports!.get_transposition_table_bits(),
+      probes: this.wasm.exports!.get_transposition_probes(),
+      hits: this.wasm.exports!.get_transposition_hits(),
+      stores: this.wasm.exports!.get_transposition_stores(),
+    };
+  }
+
+  clearTranspositionTable(): void {
+    this.wasm.exports!.clear_transposition_table();
+  }
+
+  getHeapStats(): HeapStats {
+    const fields = new Uint32Array(
+      this.wasm.memory!.buffer,
+      this.wasm.exports!.walloc_get_stats(),
+      WALLOC_STATS_FIELDS,
+    );
+    const large = 1 + WALLOC_SMALL_OBJECT_CLASSES;
+
+    return {
+      heapBytes: fields[0],
+      smallObjectBytes: Array.from(fields.subarray(1, large)),
+      largeObjectBytes: fields[large],
+      freeLargeObjects: fields[large + 1],
+      largestFreeLargeObject: fields[large + 2],
+      memoryGrowCalls: fields[large + 3],
+      coalescedLargeObjects: fields[large + 4],
+      releasedSmallObjectChunks: fields[large + 5],
+    };
+  }
+
+  /**
+   * Allocates an independent game for the sudoku_* exports, e.g. for analysis
+   * or background generation next to the one on screen. Free it with
+   * destroyContext().
+   */
+  createContext(): number {
+    const ctx = this.wasm.exports!.sudoku_create();
+    if (!ctx) {
+      throw new Error("Failed to allocate a context.");
+    }
+
+    return ctx;
+  }
+
+  destroyContext(ctx: number): void {
+    this.wasm.exports!.sudoku_destroy(ctx);
+  }
+
+  /** False unless the module was built with -DSUDOKU_TRACE=ON. */
+  isTraceAvailable(): boolean {
+    return this.wasm.exports!.is_trace_available();
+  }
+
+  setTraceEnabled(enabled: boolean): void {
+    this.wasm.exports!.trace_set_enabled(enabled);
+  }
+
+  /** Takes up to `capacity` of the oldest search events not read yet. */
+  readTrace(capacity: number = 4096): TraceEvent[] {
+    const out = this.wasm.exports!.malloc(capacity * TRACE_EVENT_SIZE);
+    if (!out) {
+      throw new Error("Failed to allocate the trace buffer.");
+    }
+
+    const read = this.wasm.exports!.trace_read(out, capacity);
+    const bytes = new Uint8Array(
+      this.wasm.memory!.buffer,
+      out,
+      read * TRACE_EVENT_SIZE,
+    );
+
+    const events: TraceEvent[] = [];
+    for (let i = 0; i < bytes.length; i += TRACE_EVENT_SIZE) {
+      events.push({
+        kind: bytes[i],
+        cell: bytes[i + 1],
+        digit: bytes[i + 2],
+        depth: bytes[i + 3],
+      });
+    }
+
+    this.wasm.exports!.free(out);
+    return events;
+  }
+
+  /** Events lost because the trace ring was full. */
+  getTraceDropped(): number {
+    return this.wasm.exports!.get_trace_dropped();
+  }
+
+  clearTrace(): void {
+    this.wasm.exports!.trace_clear();
+  }
+
+  trimHeap(): void {
+    this.wasm.exports!.walloc_trim();
+  }
+
+  /**
+   * Reverts the last edit, reported through takeDirtyCells(). Returns false
+   * when there is nothing to undo.
+   */
+  undo(): boolean {
+    return this.wasm.exports!.undo();
+  }
+
+  redo(): boolean {
+    return this.wasm.exports!.redo();
+  }
+
+  canUndo(): boolean {
+    return this.wasm.exports!.can_undo();
+  }
+
+  canRedo(): boolean {
+    return this.wasm.exports!.can_redo();
+  }
+
+  /** Runs `edit` as a single undo step. */
+  groupUndo<T>(edit: () => T): T {
+    this.wasm.exports!.begin_undo_group();
+    try {
+      return edit();
+    } finally {
+      this.wasm.exports!.end_undo_group();
+    }
+  }
+
+  takeDirtyCells(): DirtyCells {
+    const size = this.wasm.exports!.get_board_size();
+    const words = Math.ceil(size / 32);
+    const bits = new Uint32Array(
+      this.wasm.memory!.buffer,
+      this.wasm.exports!.take_dirty_cells(),
+      words * 2,
+    );
+
+    const dirty: DirtyCells = { values: [], notes: [] };
+    for (let i = 0; i < size; ++i) {
+      const mask = 1 << i % 32;
+      const word = Math.floor(i / 32);
+
+      if (bits[word] & mask) dirty.values.push(i);
+      if (bits[words + word] & mask) dirty.notes.push(i);
+    }
+
+    return dirty;
+  }
 }
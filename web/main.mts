@@ -3,4 +3,15 @@ import { SudokuController } from "./SudokuController.mjs";
 (async function initialize(): Promise<void> {
   const controller = new SudokuController("./main.wasm");
   await controller.initialize();
+
+  // The first board is painted in the next animation frame
+  requestAnimationFrame(() => {
+    performance.mark("first-board");
+    performance.measure("wasm-load", "wasm-fetch-start", "wasm-instantiated");
+    performance.measure(
+      "wasm-to-first-board",
+      "wasm-fetch-start",
+      "first-board",
+    );
+  });
 })();
@@ -1,6 +1,9 @@
 export interface WasmExports {
   memory: WebAssembly.Memory;
+  malloc: (size: number) => number;
+  free: (ptr: number) => void;
   setup: (seed: number) => void;
+  seed_puzzle: (seed: bigint, index: number) => void;
   solve_sudoku: () => boolean;
   get_board: () => number;
   get_board_size: () => number;
@@ -17,6 +20,19 @@ export interface WasmExports {
   reset_board: () => void;
   fill_test_board: () => void;
   fill_random_board: () => void;
+  prepare_random_board: () => boolean;
+  load_prepared_board: () => boolean;
+  generate_begin: () => void;
+  set_generator_options: (symmetry: Symmetry, clues: number) => void;
+  generate_step: (maxNodes: number) => TaskStatus;
+  get_generate_status: () => TaskStatus;
+  set_solver_backend: (backend: SolverBackend) => void;
+  get_solver_backend: () => SolverBackend;
+  solve_begin: () => boolean;
+  solve_step: (maxNodes: number) => TaskStatus;
+  get_solve_status: () => TaskStatus;
+  get_embedded_puzzle_count: () => number;
+  load_embedded_puzzle: (index: number) => boolean;
   is_correct_attempt: (v: number, x: number, y: number) => boolean;
   is_board_solved: () => boolean;
 
@@ -27,6 +43,219 @@ export interface WasmExports {
   reset_cell_notes: (x: number, y: number) => boolean;
   toggle_cell_note: (note: number, x: number, y: number) => number;
   cleanup_invalid_notes: (x: number, y: number) => void;
+
+  take_dirty_cells: () => number;
+  undo: () => boolean;
+  redo: () => boolean;
+  can_undo: () => boolean;
+  can_redo: () => boolean;
+  begin_undo_group: () => void;
+  end_undo_group: () => void;
+  auto_fill_notes: () => void;
+  get_candidates: () => number;
+  get_conflicts: () => number;
+  get_conflict_count: () => number;
+  is_board_complete: () => boolean;
+  check_solvable: (maxNodes: number) => Solvability;
+  get_solvability: () => Solvability;
+  get_unsolvable_entries: () => number;
+
+  find_next_step: () => number;
+
+  enumerate_begin: (limit: bigint) => boolean;
+  enumerate_next: (out: number, capacity: number) => number;
+  get_enumerated_count: () => bigint;
+  is_enumeration_done: () => boolean;
+  count_all_solutions: (limit: bigint) => bigint;
+
+  generate_grids: (out: number, count: number) => number;
+
+  get_scratch_arena_capacity: () => number;
+  get_scratch_arena_high_water: () => number;
+
+  set_transposition_table_bits: (bits: number) => boolean;
+  get_transposition_table_bits: () => number;
+  clear_transposition_table: () => void;
+  get_transposition_probes: () => bigint;
+  get_transposition_hits: () => bigint;
+  get_transposition_stores: () => bigint;
+
+  walloc_get_stats: () => number;
+  walloc_trim: () => void;
+
+  encode_state: (out: number, capacity: number) => number;
+  decode_state: (data: number, size: number) => boolean;
+  encode_state_text: (out: number, capacity: number) => number;
+  decode_state_text: (text: number, length: number) => boolean;
+
+  is_trace_available: () => boolean;
+  trace_set_enabled: (enabled: boolean) => void;
+  trace_read: (out: number, capacity: number) => number;
+  get_trace_dropped: () => number;
+  trace_clear: () => void;
+
+  get_import_buffer: () => number;
+  import_chunk: (data: number, length: number) => boolean;
+  import_finish: () => boolean;
+  get_import_malformed: () => number;
+  get_corpus_size: () => number;
+  get_corpus_puzzle: (index: number, out: number) => boolean;
+  clear_corpus: () => void;
+  load_corpus_puzzle: (index: number) => boolean;
+
+  // Explicit contexts, the functions above use the default one
+  sudoku_create: () => number;
+  sudoku_destroy: (ctx: number) => void;
+  get_default_context: () => number;
+  sudoku_seed: (ctx: number, seed: bigint, stream: bigint) => void;
+  sudoku_get_board: (ctx: number) => number;
+  sudoku_get_solved_board: (ctx: number) => number;
+  sudoku_get_board_value: (ctx: number, x: number, y: number) => number;
+  sudoku_set_board_value: (
+    ctx: number,
+    v: number,
+    x: number,
+    y: number,
+    prefilled: boolean,
+  ) => boolean;
+  sudoku_solve: (ctx: number) => boolean;
+  sudoku_set_solver_backend: (ctx: number, backend: SolverBackend) => void;
+  sudoku_solve_begin: (ctx: number) => boolean;
+  sudoku_solve_step: (ctx: number, maxNodes: number) => TaskStatus;
+  sudoku_is_board_solved: (ctx: number) => boolean;
+  sudoku_reset_board: (ctx: number) => void;
+  sudoku_fill_random_board: (ctx: number) => void;
+  sudoku_load_board: (ctx: number, givens: number, solution: number) => void;
+  sudoku_prepare_random_board: (ctx: number) => boolean;
+  sudoku_load_prepared_board: (ctx: number) => boolean;
+  sudoku_generate_begin: (ctx: number) => void;
+  sudoku_set_generator_options: (
+    ctx: number,
+    symmetry: Symmetry,
+    clues: number,
+  ) => void;
+  sudoku_generate_step: (ctx: number, maxNodes: number) => TaskStatus;
+  sudoku_load_embedded_puzzle: (ctx: number, index: number) => boolean;
+  sudoku_load_corpus_puzzle: (ctx: number, index: number) => boolean;
+  sudoku_encode_state: (ctx: number, out: number, capacity: number) => number;
+  sudoku_decode_state: (ctx: number, data: number, size: number) => boolean;
+  sudoku_get_cell_notes: (ctx: number, x: number, y: number) => number;
+  sudoku_set_cell_notes: (
+    ctx: number,
+    notes: number,
+    x: number,
+    y: number,
+  ) => boolean;
+  sudoku_auto_fill_notes: (ctx: number) => void;
+  sudoku_get_candidates: (ctx: number) => number;
+  sudoku_get_conflicts: (ctx: number) => number;
+  sudoku_check_solvable: (ctx: number, maxNodes: number) => Solvability;
+  sudoku_get_unsolvable_entries: (ctx: number) => number;
+  sudoku_take_dirty_cells: (ctx: number) => number;
+  sudoku_undo: (ctx: number) => boolean;
+  sudoku_redo: (ctx: number) => boolean;
+  sudoku_find_next_step: (ctx: number) => number;
+  sudoku_enumerate_begin: (ctx: number, limit: bigint) => boolean;
+  sudoku_enumerate_next: (ctx: number, out: number, capacity: number) => number;
+  sudoku_count_all_solutions: (ctx: number, limit: bigint) => bigint;
+}
+
+export interface DirtyCells {
+  values: number[];
+  notes: number[];
+}
+
+export enum HintTechnique {
+  NONE,
+  NAKED_SINGLE,
+  HIDDEN_SINGLE,
+  POINTING,
+  BOX_LINE_REDUCTION,
+  NAKED_SUBSET,
+  HIDDEN_SUBSET,
+  X_WING,
+  XY_WING,
+}
+
+export interface HintElimination {
+  cell: number;
+  notes: number;
+}
+
+export interface Hint {
+  technique: HintTechnique;
+  unit: number | null;
+  value: number;
+  targets: number[];
+  eliminations: HintElimination[];
+}
+
+/** Identifies a generated puzzle, which can be regenerated from it. */
+export interface PuzzleId {
+  seed: bigint;
+  index: number;
+}
+
+export interface HeapStats {
+  heapBytes: number;
+  smallObjectBytes: number[];
+  largeObjectBytes: number;
+  freeLargeObjects: number;
+  largestFreeLargeObject: number;
+  memoryGrowCalls: number;
+  coalescedLargeObjects: number;
+  releasedSmallObjectChunks: number;
+}
+
+export interface TranspositionStats {
+  bits: number; // log2 of the number of entries, 0 when disabled
+  probes: bigint;
+  hits: bigint;
+  stores: bigint;
+}
+
+// TraceEventKind from trace.h
+export enum TraceEventKind {
+  PLACE,
+  PROPAGATE,
+  REMOVE,
+  BACKTRACK,
+}
+
+export interface TraceEvent {
+  kind: TraceEventKind;
+  cell: number;
+  digit: number;
+  depth: number;
+}
+
+// Symmetry from generator.h
+export enum Symmetry {
+  NONE,
+  ROTATE_180,
+  ROTATE_90,
+  MIRROR,
+}
+
+// SolverBackend from sudoku.h
+export enum SolverBackend {
+  BACKTRACK,
+  CDCL,
+}
+
+// Solvability from oracle.h
+export enum Solvability {
+  UNKNOWN,
+  SOLVABLE,
+  UNSOLVABLE,
+}
+
+// TaskStatus from sudoku.h
+export enum TaskStatus {
+  IDLE,
+  RUNNING,
+  DONE,
+  FAILED,
 }
 
 export enum GameState {
@@ -1,24 +1,72 @@
+import { ModuleCache } from "./ModuleCache.mjs";
+
 export class Wasm<T extends WebAssembly.Exports> {
   public exports: T | null = null;
   public memory: WebAssembly.Memory | null = null;
 
   private instance: WebAssembly.Instance | null = null;
   private static readonly decoder = new TextDecoder("utf-8");
+  private static readonly cache = new ModuleCache();
 
   constructor(private readonly moduleName: string) {}
 
   public async init(): Promise<void> {
-    const response = await fetch(this.moduleName);
-    const { instance } = await WebAssembly.instantiateStreaming(
-      response,
+    performance.mark("wasm-fetch-start");
+    const module = await this.loadModule();
+    const instance = await WebAssembly.instantiate(
+      module,
       this.createImports(),
     );
+    performance.mark("wasm-instantiated");
 
     this.instance = instance;
     this.exports = this.instance.exports as T;
     this.memory = this.exports.memory as WebAssembly.Memory;
   }
 
+  /**
+   * Compiles the module while it downloads, like instantiateStreaming, and
+   * leaves repeat visits to the HTTP cache and the browser's own cache of
+   * streamed compilations. Only browsers that can store a WebAssembly.Module
+   * in IndexedDB also look it up there, keyed by the main.wasm.sha256 file the
+   * build writes next to the module. That lookup runs alongside the download
+   * instead of in front of it.
+   */
+  private async loadModule(): Promise<WebAssembly.Module> {
+    if (!ModuleCache.mayStoreModules()) {
+      return WebAssembly.compileStreaming(fetch(this.moduleName));
+    }
+
+    const download = new AbortController();
+    const response = fetch(this.moduleName, { signal: download.signal });
+    const version = await this.fetchVersion();
+    if (version) {
+      const cached = await Wasm.cache.get(this.moduleName, version);
+      if (cached) {
+        response.catch(() => {});
+        download.abort();
+        return cached;
+      }
+    }
+
+    const module = await WebAssembly.compileStreaming(response);
+    if (version) void Wasm.cache.put(this.moduleName, version, module);
+    return module;
+  }
+
+  private async fetchVersion(): Promise<string | null> {
+    try {
+      const response = await fetch(`${this.moduleName}.sha256`, {
+        cache: "no-cache",
+      });
+      if (!response.ok) return null;
+
+      return (await response.text()).trim().split(/\s+/)[0] || null;
+    } catch {
+      return null;
+    }
+  }
+
   private createImports(): WebAssembly.Imports {
     return {
       env: {